@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <lccc/cc.h>
+#include "bench.h"
+
+namespace {
+
+// the iostream formatting cc_array replaces, wrapped at 72 columns
+void by_hand(std::vector<std::uint8_t> const& blob, bool hex, std::ostream & os)
+{
+	os << "static constexpr std::uint8_t blob[" << blob.size() << "] = {\n";
+	if (hex) {
+		os << std::hex << std::setfill('0');
+	}
+	std::size_t column(0);
+	for (auto v: blob) {
+		std::size_t size(hex ? 4 : v < 10 ? 1 : v < 100 ? 2 : 3);
+		if (column != 0 && column + size + 2 > 72) {
+			os << "\n";
+			column = 0;
+		}
+		if (column == 0) {
+			os << "\t";
+		} else {
+			os << " ";
+			++column;
+		}
+		if (hex) {
+			os << "0x" << std::setw(2);
+		}
+		os << unsigned(v) << ",";
+		column += size + 1;
+	}
+	os << (column != 0 ? "\n" : "") << std::dec << std::setfill(' ') << "};\n";
+}
+
+std::string print(std::function<void(std::ostream &)> const& fn)
+{
+	std::ostringstream os;
+	fn(os);
+	return os.str();
+}
+
+// a 64 MB blob as a std::uint8_t array
+void run()
+{
+	std::vector<std::uint8_t> blob(64 << 20);
+	std::mt19937 gen(42);
+	for (auto & b: blob) {
+		b = gen();
+	}
+
+	for (auto hex: {false, true}) {
+		std::string format(hex ? "hex" : "decimal");
+		std::size_t size(0);
+		auto hand(bench::best_of(2, [&] {
+			bench::null_buffer buf;
+			std::ostream os(&buf);
+			by_hand(blob, hex, os);
+			size = buf.size();
+		}));
+		bench::report("iostream <<, " + format, hand, size);
+
+		auto make_array = [&] {
+			auto array(lccc::cc_array::make("std::uint8_t", "blob", blob));
+			array->make_static();
+			array->make_constexpr();
+			if (hex) {
+				array->make_hex();
+			}
+			return array;
+		};
+		auto node(bench::best_of(2, [&] {
+			auto array(make_array());
+			bench::null_buffer buf;
+			std::ostream os(&buf);
+			array->print(os);
+			size = buf.size();
+		}));
+		bench::report("cc_array, " + format, node, size);
+
+		auto same(print([&](std::ostream & os) { by_hand(blob, hex, os); })
+			== print([&](std::ostream & os) { make_array()->print(os); }));
+		std::cout << "  " << format << " output " << (same ? "identical" : "DIFFERENT") << std::endl;
+	}
+}
+
+bench::add array("array", run);
+
+}
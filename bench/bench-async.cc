@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <fstream>
+#include <lccc/cc.h>
+#include <lccc/output.h>
+#include "bench.h"
+
+namespace {
+
+std::size_t const repeat(10);
+
+// about 50 MB of text
+lccc::cc_namespace::ptr_t make_tree()
+{
+	auto ns(lccc::cc_namespace::make("gen"));
+	for (std::size_t n(0); n < 105000; ++n) {
+		auto cls(lccc::cc_class::make("message" + std::to_string(n)));
+		for (std::size_t i(0); i < 8; ++i) {
+			auto field("field" + std::to_string(i));
+			auto get(cls->vpublic()->add(lccc::cc_method::make("int", field)));
+			get->make_const();
+			get->define(lccc::cc_block::make())->src() << "return " << field << "_;\n";
+			cls->vprivate()->add(lccc::cc_member::make("int", field + "_"));
+		}
+		ns->add(cls);
+	}
+	return ns;
+}
+
+// 500 MB to a file on local disk, through std::ofstream and async_writer
+void run()
+{
+	auto tree(make_tree());
+	auto dir(bench::make_dir());
+	auto path(dir + "/out.h");
+
+	std::size_t size(0);
+	auto null(bench::best_of(2, [&] {
+		bench::null_buffer buf;
+		std::ostream os(&buf);
+		for (std::size_t i(0); i < repeat; ++i) {
+			tree->print(os);
+		}
+		size = buf.size();
+	}));
+	bench::report("print only", null, size);
+
+	auto stream(bench::best_of(2, [&] {
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		for (std::size_t i(0); i < repeat; ++i) {
+			tree->print(os);
+		}
+		os.close();
+		std::remove(path.c_str());
+	}));
+	bench::report("std::ofstream", stream, size);
+
+	for (auto count: {2, 4}) {
+		for (auto buffer: {1 << 20, 4 << 20}) {
+			auto async(bench::best_of(2, [&] {
+				lccc::async_writer out(path, buffer, count);
+				std::ostream os(&out);
+				for (std::size_t i(0); i < repeat; ++i) {
+					tree->print(os);
+				}
+				out.close();
+				std::remove(path.c_str());
+			}));
+			bench::report("async_writer " + std::to_string(count) + " x "
+				+ std::to_string(buffer >> 20) + " MB", async, size);
+		}
+	}
+	bench::cleanup(dir);
+}
+
+bench::add async("async", run);
+
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <lccc/cc.h>
+#include <lccc/header.h>
+#include <lccc/output.h>
+#include "bench.h"
+
+namespace {
+
+std::size_t const files(10000);
+
+lccc::header::ptr_t make_header(std::size_t n)
+{
+	auto hdr(lccc::header::make("gen/message" + std::to_string(n) + ".h"));
+	hdr->add(lccc::cpp_include::make("cstdint"));
+	auto ns(lccc::cc_namespace::make("gen"));
+	auto cls(lccc::cc_class::make("message" + std::to_string(n)));
+	for (std::size_t i(0); i < 4; ++i) {
+		auto field("field" + std::to_string(i));
+		auto get(cls->vpublic()->add(lccc::cc_method::make("std::int32_t", field)));
+		get->make_const();
+		get->define(lccc::cc_block::make())->src() << "return " << field << "_;\n";
+		cls->vprivate()->add(lccc::cc_member::make("std::int32_t", field + "_"));
+	}
+	ns->add(cls);
+	hdr->add(ns);
+	return hdr;
+}
+
+std::string name(std::string const& dir, std::size_t n)
+{
+	return dir + "/message" + std::to_string(n) + ".h";
+}
+
+// 10000 generated headers to tmpfs, one stream per file and batched
+void run()
+{
+	std::vector<lccc::header::ptr_t> headers;
+	for (std::size_t n(0); n < files; ++n) {
+		headers.push_back(make_header(n));
+	}
+	auto base(::access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp");
+	auto dir(bench::make_dir(base));
+	// best of three runs into an empty directory
+	auto measure = [&dir](std::function<void()> const& write) {
+		double best(0);
+		for (std::size_t i(0); i < 3; ++i) {
+			bench::timer t;
+			write();
+			auto seconds(t.seconds());
+			best = i == 0 ? seconds : std::min(best, seconds);
+			bench::cleanup(dir);
+			::mkdir(dir.c_str(), 0700);
+		}
+		return best;
+	};
+
+	bench::report("print only", bench::best_of(3, [&] {
+		for (auto const& hdr: headers) {
+			bench::null_buffer buf;
+			std::ostream os(&buf);
+			hdr->print(os);
+		}
+	}));
+
+	bench::report("std::ofstream per file", measure([&] {
+		for (std::size_t n(0); n < files; ++n) {
+			std::ofstream out(name(dir, n));
+			headers[n]->print(out);
+		}
+	}));
+
+	for (auto backend: {lccc::batch_writer::backend::io_uring, lccc::batch_writer::backend::threads}) {
+		bool uring(false);
+		auto seconds(measure([&] {
+			lccc::batch_writer out(4, backend);
+			uring = out.uses_io_uring();
+			for (std::size_t n(0); n < files; ++n) {
+				out.add(name(dir, n), *headers[n]);
+			}
+			out.flush();
+		}));
+		bench::report(std::string("batch_writer, ") + (uring ? "io_uring" : "4 threads"), seconds);
+	}
+	std::cout << "  in " << base << std::endl;
+	bench::cleanup(dir);
+}
+
+bench::add batch("batch", run);
+
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <lccc/cache.h>
+#include <lccc/cc.h>
+#include "bench.h"
+
+namespace {
+
+lccc::cc_class::ptr_t make_class(std::size_t n)
+{
+	auto cls(lccc::cc_class::make("message" + std::to_string(n)));
+	for (std::size_t i(0); i < 10; ++i) {
+		auto field("field" + std::to_string(i));
+		auto get(cls->vpublic()->add(lccc::cc_method::make("int", field)));
+		get->make_const();
+		get->define(lccc::cc_block::make())->src() << "return " << field << "_;\n";
+		auto set(cls->vpublic()->add(lccc::cc_method::make("void", "set_" + field)));
+		set->add_arg("int", "value");
+		set->define(lccc::cc_block::make())->src() << field << "_ = value;\n";
+		cls->vprivate()->add(lccc::cc_member::make("int", field + "_"));
+	}
+	return cls;
+}
+
+double print(lccc::src const& node, lccc::render_cache::ptr_t const& cache)
+{
+	bench::null_buffer buf;
+	std::ostream os(&buf);
+	if (cache) {
+		cache->attach(os);
+	}
+	bench::timer t;
+	node.print(os);
+	return t.seconds();
+}
+
+// 10000 classes in 50 namespaces, a warm run after adding one method
+void run()
+{
+	auto root(lccc::cc_namespace::make("gen"));
+	std::vector<lccc::cc_class::ptr_t> classes;
+	for (std::size_t n(0); n < 50; ++n) {
+		auto ns(lccc::cc_namespace::make("part" + std::to_string(n)));
+		for (std::size_t i(0); i < 200; ++i) {
+			classes.push_back(make_class(n * 200 + i));
+			ns->add(classes.back());
+		}
+		root->add(ns);
+	}
+
+	auto dir(bench::make_dir());
+	bench::report("no cache", print(*root, nullptr));
+	bench::report("cold disk cache", print(*root,
+		lccc::render_cache::make(lccc::disk_cache::make(dir, 1 << 30))));
+
+	classes[5000]->vpublic()->add(lccc::cc_method::make("void", "reset"));
+	bench::report("no cache, one method added", print(*root, nullptr));
+	bench::timer open;
+	auto disk(lccc::disk_cache::make(dir, 1 << 30));
+	bench::report("open disk cache", open.seconds());
+	auto cache(lccc::render_cache::make(disk));
+	bench::report("warm disk cache, one method added", print(*root, cache));
+	auto stats(cache->statistics());
+	std::cout << "  disk hits " << stats.disk_hits << ", misses " << stats.misses
+		<< ", " << disk->size() / 1024 << " kB on disk" << std::endl;
+	bench::cleanup(dir);
+}
+
+bench::add cache("cache", run);
+
+}
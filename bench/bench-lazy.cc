@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <lccc/cc.h>
+#include "bench.h"
+
+namespace {
+
+std::size_t const members(1000000);
+
+lccc::cc_member::ptr_t member(std::size_t n)
+{
+	return lccc::cc_member::make("std::uint32_t", "field" + std::to_string(n) + "_");
+}
+
+void print(lccc::cc_class const& cls, std::string const& what, bench::timer const& t)
+{
+	bench::null_buffer buf;
+	std::ostream os(&buf);
+	cls.print(os);
+	bench::report(what, t.seconds(), buf.size());
+}
+
+void eager()
+{
+	bench::timer t;
+	auto cls(lccc::cc_class::make("table"));
+	for (std::size_t i(0); i < members; ++i) {
+		cls->vpublic()->add(member(i));
+	}
+	print(*cls, "build and print members", t);
+}
+
+void lazy()
+{
+	bench::timer t;
+	auto cls(lccc::cc_class::make("table"));
+	cls->vpublic()->add(lccc::lazy::make([](lccc::lazy::emit_t const& emit) {
+		for (std::size_t i(0); i < members; ++i) {
+			emit(member(i));
+		}
+	}));
+	print(*cls, "print lazy members", t);
+}
+
+// peak memory of a class with a million members, built or produced
+void run()
+{
+	auto eager_kb(bench::peak_kb(eager));
+	auto lazy_kb(bench::peak_kb(lazy));
+	std::printf("  %-40s %9.1f MB\n", "peak with built members", eager_kb / 1024.0);
+	std::printf("  %-40s %9.1f MB\n", "peak with lazy members", lazy_kb / 1024.0);
+}
+
+bench::add lazy_members("lazy", run);
+
+}
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <lccc/cc.h>
+#include <lccc/output.h>
+#include "bench.h"
+
+namespace {
+
+// about 50 MB of text
+lccc::cc_namespace::ptr_t make_tree()
+{
+	auto ns(lccc::cc_namespace::make("gen"));
+	for (std::size_t n(0); n < 105000; ++n) {
+		auto cls(lccc::cc_class::make("message" + std::to_string(n)));
+		for (std::size_t i(0); i < 8; ++i) {
+			auto field("field" + std::to_string(i));
+			auto get(cls->vpublic()->add(lccc::cc_method::make("int", field)));
+			get->make_const();
+			get->define(lccc::cc_block::make())->src() << "return " << field << "_;\n";
+			cls->vprivate()->add(lccc::cc_member::make("int", field + "_"));
+		}
+		ns->add(cls);
+	}
+	return ns;
+}
+
+std::string read(std::string const& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::stringstream buf;
+	buf << in.rdbuf();
+	return buf.str();
+}
+
+// one large file through std::ofstream and mapped_writer
+void run()
+{
+	auto tree(make_tree());
+	auto dir(bench::make_dir());
+	auto streamed(dir + "/streamed.h");
+	auto mapped(dir + "/mapped.h");
+
+	std::size_t size(0);
+	auto measure(bench::best_of(3, [&] {
+		size = lccc::mapped_writer::measure(*tree);
+	}));
+	bench::report("measure()", measure, size);
+
+	bench::report("std::ofstream", bench::best_of(3, [&] {
+		std::ofstream out(streamed, std::ios::binary | std::ios::trunc);
+		tree->print(out);
+	}), size);
+
+	bench::report("mapped_writer::write (growing mapping)", bench::best_of(3, [&] {
+		lccc::mapped_writer::write(mapped, *tree);
+	}), size);
+
+	bench::report("mapped_writer, size known", bench::best_of(3, [&] {
+		lccc::mapped_writer out(mapped, size);
+		std::ostream os(&out);
+		tree->print(os);
+		out.close();
+	}), size);
+
+	std::cout << "  " << size / (1 << 20) << " MB, "
+		<< (read(streamed) == read(mapped) ? "identical" : "DIFFERENT") << std::endl;
+	std::remove(streamed.c_str());
+	std::remove(mapped.c_str());
+	bench::cleanup(dir);
+}
+
+bench::add mapped_output("mapped", run);
+
+}
@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <lccc/cc.h>
+#include "bench.h"
+
+namespace {
+
+lccc::cc_class::ptr_t make_message(std::string const& name, std::size_t pool)
+{
+	auto cls(lccc::cc_class::make(name));
+	auto ctor(cls->vpublic()->add(cls->make_constructor()));
+	ctor->add_arg("int", "id");
+	ctor->add_arg("double", "value");
+	ctor->add(lccc::cc_base_class::make("id_")->make_initializer("id"));
+	ctor->add(lccc::cc_base_class::make("value_")->make_initializer("value"));
+	ctor->define(lccc::cc_block::make());
+	auto id(cls->vpublic()->add(lccc::cc_method::make("int", "id")));
+	id->make_const();
+	id->define(lccc::cc_block::make())->src() << "return id_;\n";
+	cls->vprivate()->add(lccc::cc_member::make("int", "id_"));
+	cls->vprivate()->add(lccc::cc_member::make("double", "value_"));
+	if (pool != 0) {
+		cls->pool(pool);
+	}
+	return cls;
+}
+
+// times batches of 64 new and delete of each class, in the same order
+// a message queue would use them
+char const driver[] = R"driver(
+template <typename T>
+void run(char const* what)
+{
+	std::size_t const batch(64);
+	std::size_t const rounds(10000000 / batch);
+	T* live[batch];
+	long sum(0);
+	auto start(std::chrono::steady_clock::now());
+	for (std::size_t r(0); r < rounds; ++r) {
+		for (std::size_t i(0); i < batch; ++i) {
+			live[i] = new T(int(i), 0.5);
+		}
+		for (std::size_t i(0); i < batch; ++i) {
+			sum += live[i]->id();
+			delete live[i];
+		}
+	}
+	std::chrono::duration<double, std::nano> ns(std::chrono::steady_clock::now() - start);
+	std::printf("  %-40s %9.1f ns/op  (%ld)\n", what, ns.count() / (rounds * batch), sum);
+}
+
+int main()
+{
+	for (int i(0); i < 3; ++i) {
+		run<plain>("global operator new");
+		run<pooled>("pool(64)");
+		run<pooled_large>("pool(1024)");
+	}
+}
+)driver";
+
+// compiles the generated classes with a driver and runs it
+void run()
+{
+	auto dir(bench::make_dir());
+	{
+		std::ofstream out(dir + "/pool.cc");
+		out
+			<< "#include <chrono>\n"
+			<< "#include <cstddef>\n"
+			<< "#include <cstdio>\n"
+			<< "#include <memory>\n"
+			<< "#include <mutex>\n"
+			<< "#include <new>\n"
+			<< "#include <utility>\n";
+		make_message("plain", 0)->print(out);
+		make_message("pooled", 64)->print(out);
+		make_message("pooled_large", 1024)->print(out);
+		out << driver;
+	}
+
+	std::string compile(LCCC_BENCH_CXX " -std=c++11 -O2 -o " + dir + "/pool " + dir + "/pool.cc");
+	if (std::system(compile.c_str()) != 0) {
+		std::cerr << "  failed: " << compile << std::endl;
+	} else {
+		std::cout << std::flush;
+		std::system((dir + "/pool").c_str());
+	}
+	bench::cleanup(dir);
+}
+
+bench::add pool("pool", run);
+
+}
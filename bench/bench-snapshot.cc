@@ -0,0 +1,86 @@
+#include <fstream>
+#include <iostream>
+#include <lccc/cc.h>
+#include <lccc/snapshot.h>
+#include "bench.h"
+
+namespace {
+
+// 16 nodes per class: class, 3 sections, 4 members, 4 methods and bodies
+lccc::cc_namespace::ptr_t make_tree(std::size_t classes)
+{
+	auto ns(lccc::cc_namespace::make("gen"));
+	for (std::size_t n(0); n < classes; ++n) {
+		auto cls(lccc::cc_class::make("message" + std::to_string(n)));
+		for (std::size_t i(0); i < 4; ++i) {
+			auto field("field" + std::to_string(i));
+			auto get(cls->vpublic()->add(lccc::cc_method::make("int", field)));
+			get->make_const();
+			get->define(lccc::cc_block::make())->src() << "return " << field << "_;\n";
+			cls->vprivate()->add(lccc::cc_member::make("int", field + "_"));
+		}
+		ns->add(cls);
+	}
+	return ns;
+}
+
+std::size_t count(lccc::snapshot::node const& n)
+{
+	std::size_t res(1);
+	for (std::size_t i(0); i < n.children(); ++i) {
+		res += count(n.child(i));
+	}
+	return res;
+}
+
+// load time of a 2M node tree against building it through make()
+void run()
+{
+	std::size_t const classes(125000);
+	bench::timer build;
+	auto tree(make_tree(classes));
+	bench::report("build through make()", build.seconds());
+
+	auto dir(bench::make_dir());
+	auto path(dir + "/tree.snap");
+	{
+		bench::timer write;
+		std::ofstream out(path, std::ios::binary);
+		lccc::snapshot::write(*tree, out);
+		std::size_t size(out.tellp());
+		out.close();
+		bench::report("write snapshot", write.seconds());
+		std::cout << "  " << size / (1 << 20) << " MB snapshot" << std::endl;
+	}
+
+	bench::timer open;
+	auto snap(lccc::snapshot::open(path));
+	bench::report("open (mmap and validate)", open.seconds());
+
+	bench::timer walk;
+	auto nodes(count(snap->root()));
+	bench::report("walk all records", walk.seconds());
+	std::cout << "  " << nodes << " nodes, " << snap->size() << " records" << std::endl;
+
+	bench::null_buffer tree_buf;
+	std::ostream tree_os(&tree_buf);
+	bench::timer print_tree;
+	tree->print(tree_os);
+	bench::report("print built tree", print_tree.seconds(), tree_buf.size());
+
+	bench::null_buffer snap_buf;
+	std::ostream snap_os(&snap_buf);
+	bench::timer print_snap;
+	snap->print(snap_os);
+	bench::report("print snapshot", print_snap.seconds(), snap_buf.size());
+
+	tree.reset();
+	bench::timer load;
+	auto loaded(snap->load());
+	bench::report("load() the whole tree", load.seconds());
+	bench::cleanup(dir);
+}
+
+bench::add snapshot("snapshot", run);
+
+}
@@ -0,0 +1,91 @@
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifndef LCCC_BENCH_CXX
+#define LCCC_BENCH_CXX "c++"
+#endif
+
+namespace bench {
+
+struct entry {
+	std::string name;
+	std::function<void()> run;
+};
+
+std::vector<entry> & registry();
+
+// registers a benchmark run by bench_lccc [name...]
+struct add {
+	add(std::string const& name, std::function<void()> const& run)
+	{
+		registry().push_back(entry{name, run});
+	}
+};
+
+class timer {
+public:
+	timer()
+	:
+		start_(std::chrono::steady_clock::now())
+	{ }
+
+	double seconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
+
+// counts and drops everything printed
+class null_buffer : public std::streambuf {
+public:
+	null_buffer()
+	:
+		size_(0)
+	{ }
+
+	std::size_t size() const
+	{
+		return size_;
+	}
+
+protected:
+	int overflow(int ch) override
+	{
+		++size_;
+		return traits_type::not_eof(ch);
+	}
+
+	std::streamsize xsputn(char const*, std::streamsize size) override
+	{
+		size_ += size;
+		return size;
+	}
+
+private:
+	std::size_t size_;
+};
+
+// seconds, and throughput if bytes are given
+void report(std::string const&, double, std::size_t bytes = 0);
+// growth of the resident set while running the function in a child
+// process, in kilobytes
+std::size_t peak_kb(std::function<void()> const&);
+// a fresh directory below base, removed with everything in it by cleanup()
+std::string make_dir(std::string const& base = "/tmp");
+void cleanup(std::string const&);
+// fastest of a few runs
+double best_of(std::size_t, std::function<void()> const&);
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <dirent.h>
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench.h"
+
+namespace bench {
+
+std::vector<entry> & registry()
+{
+	static std::vector<entry> entries;
+	return entries;
+}
+
+void report(std::string const& what, double seconds, std::size_t bytes)
+{
+	std::printf("  %-40s %9.3f s", what.c_str(), seconds);
+	if (bytes != 0) {
+		std::printf("  %9.1f MB/s", bytes / seconds / (1 << 20));
+	}
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+namespace {
+
+long high_water_kb()
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0) {
+			return std::stol(line.substr(6));
+		}
+	}
+	throw std::runtime_error("bench: no VmHWM in /proc/self/status");
+}
+
+}
+
+std::size_t peak_kb(std::function<void()> const& run)
+{
+	int fds[2];
+	if (::pipe(fds) != 0) {
+		throw std::runtime_error("bench: pipe failed");
+	}
+	std::fflush(stdout);
+	pid_t pid(::fork());
+	if (pid < 0) {
+		throw std::runtime_error("bench: fork failed");
+	} else if (pid == 0) {
+		// the child starts with the resident pages of the parent, give
+		// back its free heap and start the high water mark from here
+		::malloc_trim(0);
+		std::ofstream("/proc/self/clear_refs") << "5";
+		long start(high_water_kb());
+		run();
+		long peak(high_water_kb() - start);
+		std::fflush(stdout);
+		::_exit(::write(fds[1], &peak, sizeof(peak)) == sizeof(peak) ? 0 : 1);
+	}
+
+	::close(fds[1]);
+	long peak(0);
+	auto size(::read(fds[0], &peak, sizeof(peak)));
+	::close(fds[0]);
+	int status;
+	if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+	    WEXITSTATUS(status) != 0 || size != sizeof(peak)) {
+		throw std::runtime_error("bench: child failed");
+	}
+	return peak > 0 ? peak : 0;
+}
+
+std::string make_dir(std::string const& base)
+{
+	std::string dir(base + "/lccc-bench-XXXXXX");
+	if (!::mkdtemp(&dir[0])) {
+		throw std::runtime_error("bench: can not create a directory in " + base);
+	}
+	return dir;
+}
+
+void cleanup(std::string const& dir)
+{
+	if (auto d = ::opendir(dir.c_str())) {
+		while (auto ent = ::readdir(d)) {
+			std::string name(ent->d_name);
+			if (name != "." && name != "..") {
+				std::remove((dir + "/" + name).c_str());
+			}
+		}
+		::closedir(d);
+	}
+	::rmdir(dir.c_str());
+}
+
+double best_of(std::size_t runs, std::function<void()> const& run)
+{
+	double best(0);
+	for (std::size_t i(0); i < runs; ++i) {
+		timer t;
+		run();
+		auto seconds(t.seconds());
+		best = i == 0 ? seconds : std::min(best, seconds);
+	}
+	return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> names(argv + 1, argv + argc);
+	int res(0);
+	for (auto const& e: bench::registry()) {
+		if (!names.empty() && std::find(names.begin(), names.end(), e.name) == names.end()) {
+			continue;
+		}
+		std::cout << e.name << ":" << std::endl;
+		try {
+			e.run();
+		} catch (std::exception const& ex) {
+			std::cout << "  failed: " << ex.what() << std::endl;
+			res = 1;
+		}
+	}
+	return res;
+}
@@ -26,26 +26,82 @@
 #ifndef LCCC_H
 #define LCCC_H
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace lccc {
 
+class hasher;
+class snapshot;
+class snapshot_writer;
+
+// Characters owned elsewhere, the member of a node or a field of a
+// mapped snapshot.
+class text_ref {
+public:
+	text_ref(char const*);
+	text_ref(char const*, std::size_t);
+	text_ref(std::string const&);
+
+	char const* data() const;
+	std::size_t size() const;
+	bool empty() const;
+	std::string str() const;
+
+private:
+	char const* data_;
+	std::size_t size_;
+};
+
+bool operator==(text_ref const&, text_ref const&);
+bool operator!=(text_ref const&, text_ref const&);
+std::ostream & operator<<(std::ostream &, text_ref const&);
+
 class src {
 public:
 	using ptr_t = std::shared_ptr<src>;
 
 	virtual std::ostream & print(std::ostream & os) const = 0;
+	// feed the structure of this node into the hasher, returns
+	// false if the output can not be derived from the structure
+	virtual bool hash(hasher &) const;
+	// store this node and its children in a snapshot, returns false
+	// if the node has no snapshot representation
+	virtual bool write(snapshot_writer &) const;
 	virtual ~src();
 };
 
 class container : public src {
 protected:
 	std::ostream & print_content(std::ostream & os) const;
+	bool hash_content(hasher &) const;
+	std::vector<std::uint32_t> write_content(snapshot_writer &) const;
 
 	std::vector<src::ptr_t> content_;
 };
 
+// Calls its producer each time it is printed. Every node the producer
+// emits is printed right away and released, so large generated content
+// never has to exist as a whole.
+class lazy : public src {
+public:
+	using ptr_t = std::shared_ptr<lazy>;
+	using emit_t = std::function<void(src::ptr_t const&)>;
+	using producer_t = std::function<void(emit_t const&)>;
+
+	static ptr_t make(producer_t const&);
+	std::ostream & print(std::ostream &) const;
+
+private:
+	lazy(producer_t const&);
+
+	producer_t producer_;
+};
+
 }
 
 #endif
@@ -0,0 +1,130 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_CACHE_H
+#define LCCC_CACHE_H
+
+#include <lccc/base.h>
+#include <lccc/hash.h>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace lccc {
+
+// A directory of rendered fragments named by their structural hash,
+// shared between generator runs. Once the fragments exceed max_size
+// the least recently used ones are removed. Fragments below min_size
+// are not worth a file and are not stored. The modification time of
+// a fragment records its last use.
+class disk_cache {
+public:
+	using ptr_t = std::shared_ptr<disk_cache>;
+
+	static ptr_t make(std::string const&, std::size_t max_size, std::size_t min_size = 4096);
+
+	bool load(std::uint64_t, std::string &);
+	void store(std::uint64_t, std::string const&);
+	std::size_t size() const;
+	std::size_t max_size() const;
+	std::size_t min_size() const;
+
+private:
+	struct entry {
+		entry(std::uint64_t, std::size_t);
+
+		std::uint64_t key;
+		std::size_t size;
+	};
+
+	disk_cache(std::string const&, std::size_t, std::size_t);
+	std::string path(std::uint64_t) const;
+	void scan();
+	void evict();
+
+	std::string dir_;
+	std::size_t max_size_;
+	std::size_t min_size_;
+	std::size_t size_;
+	std::list<entry> lru_;
+	std::unordered_map<std::uint64_t, std::list<entry>::iterator> index_;
+};
+
+// Renders structurally identical subtrees only once. Attach it to a
+// stream before printing, every container then looks up its children
+// by structural hash and reuses the bytes of earlier renderings.
+// Fragments carry a second hash, a fragment whose check does not match
+// is rendered again. With a disk_cache the fragments large enough for
+// it are kept across runs.
+class render_cache {
+public:
+	using ptr_t = std::shared_ptr<render_cache>;
+
+	struct stats {
+		stats();
+		double hit_rate() const;
+
+		std::size_t hits;
+		std::size_t disk_hits;
+		std::size_t misses;
+		std::size_t bytes_saved;
+		std::size_t bytes_cached;
+	};
+
+	// part of every key, bump it whenever the printed text changes
+	static std::uint64_t const version = 2;
+
+	static ptr_t make();
+	static ptr_t make(disk_cache::ptr_t const&);
+	static render_cache * get(std::ostream &);
+
+	void attach(std::ostream &);
+	void detach(std::ostream &);
+	std::ostream & print(src const&, std::ostream &);
+	stats statistics() const;
+	void clear();
+
+private:
+	struct fragment {
+		std::uint64_t check;
+		std::string text;
+	};
+
+	render_cache(disk_cache::ptr_t const&);
+	bool load(std::uint64_t, std::uint64_t);
+	std::ostream & render(src const&, std::ostream &, std::uint64_t, std::uint64_t);
+
+	disk_cache::ptr_t disk_;
+	std::unordered_map<std::uint64_t, fragment> fragments_;
+	// digests of the nodes below the outermost print(), which are
+	// looked up again while it renders them
+	hasher::memo_t digests_;
+	std::size_t depth_;
+	stats stats_;
+};
+
+}
+
+#endif
@@ -27,7 +27,10 @@
 #define LCCC_CC_H
 
 #include <lccc/base.h>
+#include <lccc/raw.h>
+#include <mutex>
 #include <sstream>
+#include <type_traits>
 
 namespace lccc {
 
@@ -37,9 +40,15 @@ public:
 
 	static ptr_t make();
 	std::ostream & print(std::ostream & os) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 	std::ostream & src();
+	void prepend(std::string const&);
 private:
+	friend class snapshot;
+
 	cc_block();
+	static std::ostream & format(std::ostream &, text_ref);
 
 	std::stringstream source_;
 };
@@ -48,11 +57,6 @@ class cc_method_base : public src {
 public:
 	using ptr_t = std::shared_ptr<cc_method_base>;
 
-	void add_arg(std::string const&, std::string name = "");
-	cc_block::ptr_t define(cc_block::ptr_t const& src);
-	std::string name() const;
-
-protected:
 	struct argument {
 		argument(std::string const&, std::string const&);
 
@@ -60,13 +64,68 @@ protected:
 		std::string name;
 	};
 
+	void add_arg(std::string const&, std::string name = "");
+	cc_block::ptr_t define(cc_block::ptr_t const& src);
+	std::string name() const;
+	std::vector<argument> const& arguments() const;
+	// nullptr if the method is only declared
+	cc_block::ptr_t body() const;
+	// noexcept(condition) unless the condition is empty
+	void make_noexcept(std::string const& condition = "");
+	void make_constexpr();
+	void make_inline();
+	// = default and = delete, replace a definition
+	void make_default();
+	void make_delete();
+	bool is_default() const;
+	bool is_deleted() const;
+	bool is_noexcept() const;
+	std::string const& noexcept_condition() const;
+	// printed as [[attribute]] in front of the declaration
+	void add_attribute(std::string const&);
+	std::vector<std::string> const& attributes() const;
+
+protected:
+	friend class snapshot;
+
+	// a method as printed, from the node or from its snapshot record
+	struct declaration {
+		declaration(text_ref, unsigned);
+
+		text_ref name;
+		unsigned qualifiers;
+		std::vector<text_ref> attributes;
+		text_ref condition;
+		// types and names in turn
+		std::vector<text_ref> args;
+	};
+	using body_t = std::function<void()>;
+
 	cc_method_base(std::string const&);
-	std::string args() const;
-	std::string named_args() const;
+	bool hash_base(hasher &) const;
+	unsigned qualifiers() const;
+	std::vector<std::string> base_fields() const;
+	std::vector<std::uint32_t> write_src(snapshot_writer &) const;
+	declaration declare() const;
+	// empty if the method is only declared
+	body_t body_printer(std::ostream &) const;
+	static void format_attributes(std::ostream &, declaration const&);
+	static void format_specifiers(std::ostream &, declaration const&);
+	static void format_args(std::ostream &, declaration const&, bool);
+	static void format_exceptions(std::ostream &, declaration const&);
+	// = default or = delete, empty for neither
+	static char const* special(declaration const&);
 
 	std::string name_;
 	std::vector<argument> args_;
 	cc_block::ptr_t src_;
+	bool noexcept_;
+	std::string condition_;
+	bool constexpr_;
+	bool inline_;
+	bool default_;
+	bool delete_;
+	std::vector<std::string> attributes_;
 };
 
 class cc_method : public cc_method_base {
@@ -78,16 +137,33 @@ public:
 	void make_virtual();
 	void make_abstract();
 	void make_const();
+	void make_final();
+	void make_static();
+	// drops virtual, = 0 and final
+	void make_nonvirtual();
+	bool is_virtual() const;
+	bool is_abstract() const;
+	bool is_const() const;
+	std::string rtype() const;
 
 	std::ostream & print(std::ostream & os) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 private:
+	friend class snapshot;
+
 	cc_method(std::string const&, std::string const&);
+	std::uint8_t flags() const;
+	static std::ostream & format(std::ostream &, declaration const&, text_ref,
+		std::uint8_t, body_t const&);
 
 	std::string rtype_;
 	bool virtual_;
 	bool abstract_;
 	bool const_;
+	bool final_;
+	bool static_;
 };
 
 class cc_namespace : public container {
@@ -97,9 +173,14 @@ public:
 	static ptr_t make(std::string const&);
 	src::ptr_t add(src::ptr_t const&);
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 private:
+	friend class snapshot;
+
 	cc_namespace(std::string const&);
+	static std::ostream & format(std::ostream &, text_ref, std::function<void()> const&);
 
 	std::string name_;
 };
@@ -110,12 +191,196 @@ public:
 
 	static ptr_t make(std::string const&, std::string const&);
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
+
+	// placed first or last by cc_class::layout()
+	void make_hot();
+	void make_cold();
+	// alignas(n), e.g. a cache line against false sharing
+	void align(std::size_t);
+	// size and alignment of the type, known for fundamental types and
+	// pointers on LP64
+	void layout(std::size_t, std::size_t);
+	// width in bits when packed by cc_class::pack(), bool packs into
+	// one bit by default
+	void pack(std::size_t);
+
+	std::string type() const;
+	std::string name() const;
+	bool hot() const;
+	bool cold() const;
+	// 0 if unknown
+	std::size_t size() const;
+	std::size_t alignment() const;
+	// 0 if the member is not packed
+	std::size_t bits() const;
+	// the type starts with static
+	bool is_static() const;
+	// an arithmetic type with a known layout, no pointer
+	bool fundamental() const;
+	// a fundamental signed integer, char is signed as on x86-64
+	bool is_signed() const;
 
 private:
+	friend class snapshot;
+
 	cc_member(std::string const&, std::string const&);
+	static std::ostream & format(std::ostream &, text_ref, text_ref, std::size_t);
+
+	std::string name_;
+	std::string type_;
+	bool hot_;
+	bool cold_;
+	std::size_t align_;
+	std::size_t size_;
+	std::size_t type_align_;
+	std::size_t bits_;
+};
+
+// A numeric table written as an array definition. The elements are not
+// copied unless given as a vector, a pointer has to stay valid as long
+// as the node is printed. Empty data throws std::invalid_argument, a
+// zero sized array is ill-formed.
+class cc_array : public src {
+public:
+	using ptr_t = std::shared_ptr<cc_array>;
+
+	enum class element : std::uint8_t {
+		int8 = 1, int16, int32, int64,
+		uint8, uint16, uint32, uint64,
+		float32, float64,
+	};
+
+	template <typename T>
+	static ptr_t make(std::string const&, std::string const&, T const*, std::size_t);
+	template <typename T>
+	static ptr_t make(std::string const&, std::string const&, std::vector<T> const&);
+
+	void make_static();
+	void make_constexpr();
+	// integers only, floating point elements stay decimal
+	void make_hex();
+	void align(std::size_t);
+	// pack as many elements per line as fit into the given columns
+	void wrap(std::size_t);
+
+	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
+	std::string name() const;
+	element type() const;
+	void const* data() const;
+	std::size_t size() const;
+
+private:
+	friend class snapshot;
+
+	template <typename T>
+	static element element_of();
+	static std::size_t width(element);
+	// the elements do not have to be aligned
+	static std::ostream & format(std::ostream &, text_ref, text_ref, element,
+		void const*, std::size_t, std::uint8_t, std::size_t, std::size_t);
+	std::uint8_t flags() const;
+
+	cc_array(std::string const&, std::string const&, element,
+		std::shared_ptr<void const> const&, void const*, std::size_t);
+
+	std::string type_;
+	std::string name_;
+	element element_;
+	std::shared_ptr<void const> owner_;
+	void const* data_;
+	std::size_t size_;
+	bool static_;
+	bool constexpr_;
+	bool hex_;
+	std::size_t align_;
+	std::size_t wrap_;
+};
+
+template <typename T>
+cc_array::element cc_array::element_of()
+{
+	static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+		"cc_array elements have to be numbers");
+
+	if (std::is_floating_point<T>::value) {
+		static_assert(!std::is_floating_point<T>::value || sizeof(T) == 4 || sizeof(T) == 8,
+			"unsupported floating point type");
+		return sizeof(T) == 4 ? element::float32 : element::float64;
+	}
+
+	auto first(std::is_signed<T>::value ? element::int8 : element::uint8);
+	switch (sizeof(T)) {
+	case 1: return first;
+	case 2: return element(std::uint8_t(first) + 1);
+	case 4: return element(std::uint8_t(first) + 2);
+	default: return element(std::uint8_t(first) + 3);
+	}
+}
+
+template <typename T>
+cc_array::ptr_t cc_array::make(std::string const& type, std::string const& name,
+	T const* data, std::size_t size)
+{
+	return ptr_t(new cc_array(type, name, element_of<T>(), nullptr, data, size));
+}
+
+template <typename T>
+cc_array::ptr_t cc_array::make(std::string const& type, std::string const& name,
+	std::vector<T> const& data)
+{
+	auto copy(std::make_shared<std::vector<T> const>(data));
+	return ptr_t(new cc_array(type, name, element_of<T>(), copy, copy->data(), copy->size()));
+}
+
+// An enumeration with string conversions printed after it: to_string()
+// indexes a constexpr name table, or searches a sorted one if the values
+// are sparse, from_string() finds the name through a perfect hash. None
+// of them allocates. The functions are inline at namespace scope and
+// static members in a class. The hash is searched for once and kept
+// until the next add(), which throws std::invalid_argument if the
+// implicit value would overflow. The generated code needs <cstdint>
+// and <cstring>.
+class cc_enum : public src {
+public:
+	using ptr_t = std::shared_ptr<cc_enum>;
+
+	static ptr_t make(std::string const&, std::string const& = "");
+	void make_scoped();
+	void add(std::string const&);
+	void add(std::string const&, std::int64_t);
+	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
+	std::string name() const;
+
+private:
+	friend class cc_class;
+	friend class snapshot;
+
+	struct enumerator {
+		enumerator(std::string const&, std::int64_t, bool);
+
+		std::string name;
+		std::int64_t value;
+		bool given;
+	};
+
+	cc_enum(std::string const&, std::string const&);
+	void add(enumerator const&);
+	void print_to_string(std::ostream &) const;
+	cc_block::ptr_t from_string() const;
 
 	std::string name_;
 	std::string type_;
+	bool scoped_;
+	bool member_;
+	std::vector<enumerator> enumerators_;
+	mutable std::mutex mutex_;
+	mutable cc_block::ptr_t from_string_;
 };
 
 class cc_base_class : public src {
@@ -127,10 +392,14 @@ public:
                 using ptr_t = std::shared_ptr<initializer>;
 
                 std::ostream & print(std::ostream &) const;
+                bool hash(hasher &) const;
+                bool write(snapshot_writer &) const;
         private:
                 friend class cc_base_class;
+                friend class snapshot;
 
                 initializer(std::string const&, std::string const&);
+                static std::ostream & format(std::ostream &, text_ref, text_ref);
 
                 std::string name_;
                 std::string init_;
@@ -138,7 +407,10 @@ public:
 
         static ptr_t make(std::string const&);
         std::ostream & print(std::ostream &) const;
+        bool hash(hasher &) const;
+        bool write(snapshot_writer &) const;
         initializer::ptr_t make_initializer(std::string const&);
+        std::string name() const;
 
 private:
         cc_base_class(std::string const&);
@@ -155,12 +427,17 @@ public:
 		using ptr_t = std::shared_ptr<constructor>;
 
 		std::ostream & print(std::ostream & os) const;
+		bool hash(hasher &) const;
+		bool write(snapshot_writer &) const;
 		cc_base_class::initializer::ptr_t
 		add(cc_base_class::initializer::ptr_t const&);
 	private:
 		friend class cc_class;
+		friend class snapshot;
 
 		constructor(std::string const&);
+		static std::ostream & format(std::ostream &, declaration const&, std::size_t,
+			std::function<void(std::size_t)> const&, body_t const&);
 
 		std::vector<cc_base_class::initializer::ptr_t> initializers_;
 	};
@@ -170,14 +447,23 @@ public:
 		using ptr_t = std::shared_ptr<destructor>;
 
 		std::ostream & print(std::ostream &) const;
+		bool hash(hasher &) const;
+		bool write(snapshot_writer &) const;
 		void make_virtual();
+		void make_final();
+		bool is_virtual() const;
 
 	private:
 		friend class cc_class;
+		friend class snapshot;
 
 		destructor(std::string const&);
+		std::uint8_t flags() const;
+		static std::ostream & format(std::ostream &, declaration const&, std::uint8_t,
+			body_t const&);
 
 		bool virtual_;
+		bool final_;
 	};
 
 	class visibility : public container {
@@ -185,35 +471,140 @@ public:
 		using ptr_t = std::shared_ptr<visibility>;
 
 		std::ostream & print(std::ostream & os) const;
+		bool hash(hasher &) const;
+		bool write(snapshot_writer &) const;
 		cc_method::ptr_t add(cc_method::ptr_t const&);
 		cc_member::ptr_t add(cc_member::ptr_t const&);
 		constructor::ptr_t add(constructor::ptr_t const&);
 		destructor::ptr_t add(destructor::ptr_t const&);
+		lazy::ptr_t add(lazy::ptr_t const&);
+		raw::ptr_t add(raw::ptr_t const&);
+		cc_array::ptr_t add(cc_array::ptr_t const&);
+		cc_enum::ptr_t add(cc_enum::ptr_t const&);
+		cc_class::ptr_t add(cc_class::ptr_t const&);
+		std::vector<cc_member::ptr_t> members() const;
+		std::vector<cc_method::ptr_t> methods() const;
+		std::vector<constructor::ptr_t> constructors() const;
 
 	private:
 		friend class cc_class;
+		friend class snapshot;
 
 		visibility(std::string const&);
+		static std::ostream & format(std::ostream &, text_ref, bool,
+			std::function<void()> const&);
+		void layout();
+		void pack();
 
 		std::string keyword_;
 	};
 
+	enum class byte_order {
+		little,
+		big,
+	};
+
+	struct layout_info {
+		std::size_t size;
+		std::size_t alignment;
+		std::size_t padding;
+	};
 
 	static ptr_t make(std::string const&);
 
+	void make_final();
+	// printed as template <parameter, ...> in front of the class
+	void add_template_parameter(std::string const&);
 	constructor::ptr_t make_constructor() const;
+	// memberwise, bases and data members are moved. noexcept if they
+	// all move without throwing, which is checked through <type_traits>
+	// for the ones that are not fundamental types or pointers.
+	constructor::ptr_t make_move_constructor() const;
+	cc_method::ptr_t make_move_assignment() const;
+	// memberwise, bases and data members are copied. The argument of
+	// these four is unnamed if there is nothing to copy or move.
+	constructor::ptr_t make_copy_constructor() const;
+	cc_method::ptr_t make_copy_assignment() const;
 	destructor::ptr_t make_destructor() const;
 	visibility::ptr_t vprivate() const;
 	visibility::ptr_t vpublic() const;
 	visibility::ptr_t vprotected() const;
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 	cc_base_class::ptr_t add(cc_base_class::ptr_t const&);
+	std::vector<cc_base_class::ptr_t> const& bases() const;
+	// replaces the base class with the given name, returns false if
+	// there is none
+	bool replace(std::string const&, cc_base_class::ptr_t const&);
 	std::string name() const;
+	// methods of all sections in declaration order
+	std::vector<cc_method::ptr_t> methods() const;
+	std::vector<constructor::ptr_t> constructors() const;
+	// data members of all sections in declaration order
+	std::vector<cc_member::ptr_t> members() const;
+	// sizeof estimate for the data members in their current order,
+	// throws std::invalid_argument if a size is unknown
+	layout_info estimate() const;
+	// reorders the data members of each section to minimize padding,
+	// hot members first and cold members last
+	layout_info layout();
+	// replaces the bool members and members with a bit width in each
+	// section by packed words, accessed through a getter and a setter
+	// named like the member. Values are stored unsigned, the getter
+	// sign-extends members of a signed integer type.
+	void pack();
+	// class specific operator new and delete taking objects from a thread
+	// local freelist, refilled with blocks of the given number of objects.
+	// Blocks are never returned before exit, so objects may be deleted on
+	// any thread. Derived classes and arrays use the global allocator.
+	// Adds make_pooled(args...) returning a std::unique_ptr. The generated
+	// code needs <cstddef>, <memory>, <mutex>, <new> and <utility>.
+	void pool(std::size_t = 64);
+	// serialize(char*) const and deserialize(char const*) writing the
+	// data members in declaration order without padding, and a constexpr
+	// serialized_size(). Fundamental types and enumerations, through
+	// their underlying type, are stored in the given byte order. Other
+	// members have to serialize themselves, like classes made
+	// serializable with this. Throws std::invalid_argument for pointers
+	// and long double, which has no portable byte order. Fundamental
+	// members found adjacent by estimate() are copied with one memcpy if
+	// the host byte order matches. The generated code needs <cstddef>,
+	// <cstdint>, <cstring>, <type_traits> and the GCC byte order macros
+	// and builtins.
+	void serialize(byte_order = byte_order::little);
+	// operator==, operator!= and hash_value() over the data members.
+	// Adjacent integral members are compared with one memcmp, floating
+	// point members by value with -0.0 hashing like 0.0, enumerations by
+	// their underlying value and others with == and std::hash. Returns
+	// the std::hash specialization for the class, named by the given
+	// qualified name, to be printed at global scope. The generated code
+	// needs <cstdint>, <cstring>, <functional> and <type_traits>.
+	raw::ptr_t hashable(std::string const& = "");
+	// compile time member descriptors: a nested field_descriptor with
+	// name, offsetof, size, type and an FNV-1a type_id of the type name,
+	// and static constexpr field_count() and field(index). Returns the
+	// constexpr array <class>_fields, to be printed after the class in the
+	// same namespace. offsetof needs a standard layout class. The
+	// generated code needs <cstddef>, <cstdint> and <stdexcept>.
+	raw::ptr_t reflect();
 
 private:
+	friend class snapshot;
+
 	cc_class(std::string const&);
+	static std::ostream & format(std::ostream &, text_ref, bool, std::vector<text_ref> const&,
+		std::size_t, std::function<void(std::size_t)> const&, std::function<void()> const&);
+	bool has_vptr() const;
+	// non-static data members, each with whether it directly follows
+	// the previous one in the estimated layout
+	std::vector<std::pair<cc_member::ptr_t, bool>> data_members() const;
+	// the bases and member types a move may throw for
+	std::vector<std::string> moved_types() const;
 
 	std::string name_;
+	bool final_;
+	std::vector<std::string> template_parameters_;
 	visibility::ptr_t public_;
 	visibility::ptr_t protected_;
 	visibility::ptr_t private_;
@@ -36,9 +36,14 @@ public:
 
 	static ptr_t make(std::string const&);
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 private:
+	friend class snapshot;
+
 	cpp_define(std::string const&);
+	static std::ostream & format(std::ostream &, text_ref);
 
 	std::string symbol_;
 };
@@ -48,12 +53,22 @@ public:
 	using ptr_t = std::shared_ptr<cpp_include>;
 
 	static ptr_t make(std::string const&);
+	// #include "name" instead of #include<name>
+	static ptr_t make_local(std::string const&);
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
+	std::string name() const;
+	bool local() const;
 
 private:
-	cpp_include(std::string const&);
+	friend class snapshot;
+
+	cpp_include(std::string const&, bool);
+	static std::ostream & format(std::ostream &, text_ref, bool);
 
 	std::string name_;
+	bool local_;
 };
 
 class cpp_condition : public container {
@@ -61,11 +76,19 @@ public:
 	using ptr_t = std::shared_ptr<cpp_condition>;
 
 	src::ptr_t add(src::ptr_t const&);
+	src::ptr_t insert(std::size_t, src::ptr_t const&);
+	src::ptr_t replace(std::size_t, src::ptr_t const&);
 
 	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 protected:
+	friend class snapshot;
+
 	cpp_condition(std::string const&, std::string const&);
+	static std::ostream & format(std::ostream &, text_ref, text_ref,
+		std::function<void()> const&);
 
 	std::string symbol_;
 	std::string cond_;
@@ -95,7 +118,12 @@ public:
 
 	static ptr_t make(std::string const&);
 	src::ptr_t add(src::ptr_t const&);
+	// positions count from the first node after the guard #define
+	src::ptr_t insert(std::size_t, src::ptr_t const&);
+	src::ptr_t replace(std::size_t, src::ptr_t const&);
 	std::ostream & print(std::ostream & os) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 private:
 	cpp_guard(std::string const&);
@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_CRTP_H
+#define LCCC_CRTP_H
+
+#include <lccc/cc.h>
+
+namespace lccc {
+
+// Static dispatch for an interface of abstract methods. base() is a
+// template over the implementing class which forwards each abstract
+// method to the implementation without a virtual call, derive() moves a
+// class implementing the interface onto that base. adapter() implements
+// the interface for an implementation held by value, for the places
+// which still need runtime polymorphism. The generated code needs
+// <utility>.
+class cc_crtp {
+public:
+	using ptr_t = std::shared_ptr<cc_crtp>;
+
+	static ptr_t make(cc_class::ptr_t const&);
+	// template <typename Derived> class <interface>_crtp
+	cc_class::ptr_t base() const;
+	// template <typename Impl> class <interface>_adapter
+	cc_class::ptr_t adapter() const;
+	// replaces the interface base class by the template base and makes
+	// the implementations non-virtual, throws std::invalid_argument if
+	// the class is not derived from the interface or misses a method
+	void derive(cc_class::ptr_t const&) const;
+
+private:
+	cc_crtp(cc_class::ptr_t const&);
+
+	std::vector<cc_method::ptr_t> abstract() const;
+
+	cc_class::ptr_t interface_;
+};
+
+}
+
+#endif
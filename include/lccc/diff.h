@@ -0,0 +1,68 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_DIFF_H
+#define LCCC_DIFF_H
+
+#include <lccc/snapshot.h>
+#include <map>
+
+namespace lccc {
+
+struct change {
+	enum class type {
+		added,
+		removed,
+		modified,
+	};
+
+	change(type, snapshot::kind, std::vector<std::string> const&,
+		src const*, src const*);
+
+	type what;
+	snapshot::kind kind;
+	// names of the enclosing namespaces, classes and sections
+	// down to the changed node, or the file name for a file map
+	std::vector<std::string> path;
+	src const* old_node;
+	src const* new_node;
+};
+
+using file_map = std::map<std::string, src::ptr_t>;
+
+// Compare two trees by structural hash. Unchanged subtrees are skipped,
+// changed namespaces, classes, sections and preprocessor conditions are
+// descended into and any other node is reported as a whole. Lazy nodes
+// have no structure before they are printed, any node holding one
+// directly is reported as modified and a lazy root throws
+// std::invalid_argument.
+std::vector<change> diff(src const&, src const&);
+
+// One change per output file that was added, removed or modified.
+std::vector<change> diff(file_map const&, file_map const&);
+
+}
+
+#endif
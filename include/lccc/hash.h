@@ -0,0 +1,75 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_HASH_H
+#define LCCC_HASH_H
+
+#include <lccc/base.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace lccc {
+
+// 64 bit FNV-1a over the structure of a tree, next to a second state
+// with other constants as a check against collisions of the first.
+// Each node is hashed on its own and enters its parent by its digest.
+// With a memo the digests of nodes costing more than a few hundred
+// bytes to hash are kept, so large subtrees are hashed once however
+// deep they are nested.
+class hasher {
+public:
+	struct digest {
+		bool valid;
+		std::uint64_t value;
+		std::uint64_t check;
+	};
+	// valid while the nodes in it are neither changed nor released
+	using memo_t = std::unordered_map<src const*, digest>;
+
+	hasher();
+	explicit hasher(memo_t *);
+
+	hasher & add(char const*);
+	hasher & add(char const*, std::size_t);
+	hasher & add(std::string const&);
+	hasher & add(std::uint64_t);
+	hasher & add(bool);
+	bool add(src const&);
+	std::uint64_t value() const;
+	std::uint64_t check() const;
+
+private:
+	void update(void const*, std::size_t);
+
+	std::uint64_t state_;
+	std::uint64_t check_;
+	// hashed here and below, decides whether a digest is kept
+	std::size_t bytes_;
+	memo_t * memo_;
+};
+
+}
+
+#endif
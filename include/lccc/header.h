@@ -35,13 +35,26 @@ public:
 	using ptr_t = std::shared_ptr<header>;
 
 	static ptr_t make(std::string const&);
+	// a cpp_include goes to the include registry at the top of the
+	// header: printed once, system includes before local ones, each
+	// group in the order of first addition
 	void add(src::ptr_t const&);
+	// sorts the includes of each group by name, so the output does not
+	// depend on the order the includes were added in
+	void make_deterministic();
 	std::ostream & print(std::ostream & os) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
 
 private:
 	header(std::string const&);
+	bool before(cpp_include const&, cpp_include const&) const;
 
+	std::string name_;
+	bool deterministic_;
 	cpp_guard::ptr_t guard_;
+	// registered includes in printing order, the first guard_ nodes
+	std::vector<cpp_include::ptr_t> includes_;
 };
 
 }
@@ -40,6 +40,7 @@ public:
 
 protected:
 	int overflow(int) override;
+	std::streamsize xsputn(char const*, std::streamsize) override;
 
 private:
 	std::string indent_;
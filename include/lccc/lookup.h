@@ -0,0 +1,74 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_LOOKUP_H
+#define LCCC_LOOKUP_H
+
+#include <lccc/cc.h>
+
+namespace lccc {
+
+// Generates a function mapping strings to values through a minimal
+// perfect hash, which is searched for when the function is generated:
+//
+//   rtype name(char const* key, std::size_t size);
+//
+// The function holds a displacement and a key table, one hash of the
+// key and one string compare decide the result. Keys not in the set
+// map to the fallback. Without a fallback the function reports misses
+// instead and stores the value on a hit:
+//
+//   bool name(char const* key, std::size_t size, rtype & value);
+//
+// The generated code needs <cstdint> and <cstring>.
+class cc_lookup {
+public:
+	using ptr_t = std::shared_ptr<cc_lookup>;
+
+	static ptr_t make(std::string const&, std::string const&, std::string const& = "");
+	void add(std::string const&, std::string const&);
+	cc_method::ptr_t generate() const;
+	// the function body alone, for callers declaring the function
+	cc_block::ptr_t body() const;
+
+private:
+	struct entry {
+		entry(std::string const&, std::string const&);
+
+		std::string key;
+		std::string value;
+	};
+
+	cc_lookup(std::string const&, std::string const&, std::string const&);
+
+	std::string rtype_;
+	std::string name_;
+	std::string fallback_;
+	std::vector<entry> entries_;
+};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_OUTPUT_H
+#define LCCC_OUTPUT_H
+
+#include <lccc/base.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+namespace lccc {
+
+// A streambuf writing to a file from a thread of its own. Output is
+// collected in one of count buffers while the thread writes the filled
+// ones with writev(), so printing and disk I/O overlap:
+//
+//   async_writer out("foo.h");
+//   std::ostream os(&out);
+//   hdr->print(os);
+//   out.close();
+class async_writer : public std::streambuf {
+public:
+	explicit async_writer(std::string const&,
+		std::size_t size = 1 << 20, std::size_t count = 2);
+	~async_writer() override;
+
+	// flushes all output and closes the file, throws on write errors
+	void close();
+
+protected:
+	int overflow(int) override;
+	int sync() override;
+
+private:
+	struct slot {
+		slot(std::size_t, std::size_t);
+
+		std::size_t index;
+		std::size_t size;
+	};
+
+	async_writer(async_writer const&) = delete;
+	async_writer & operator=(async_writer const&) = delete;
+
+	void run();
+	bool submit();
+	bool drain();
+	void write(std::vector<slot> const&);
+	void stop();
+
+	int fd_;
+	std::vector<std::vector<char>> buffers_;
+	std::size_t current_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<std::size_t> free_;
+	std::deque<slot> full_;
+	bool busy_;
+	bool stop_;
+	int error_;
+	std::thread thread_;
+};
+
+// Writes many files at once. Files are collected with add() and
+// written by flush(), by a pool of threads or, on request and where the
+// kernel (5.15 or later) offers it, through io_uring with one linked
+// open, write and close per file, submitted in batches. The thread
+// pool is the default, it is as fast or faster on tmpfs and local disks.
+class batch_writer {
+public:
+	enum class backend {
+		threads,
+		io_uring,
+	};
+
+	explicit batch_writer(std::size_t threads = 4, backend = backend::threads);
+	~batch_writer();
+
+	void add(std::string const&, std::string const&);
+	void add(std::string const&, src const&);
+	// throws for the first file that could not be written,
+	// all other files are written nevertheless
+	void flush();
+	bool uses_io_uring() const;
+
+private:
+	struct file {
+		file(std::string const&, std::string const&);
+
+		std::string path;
+		std::string data;
+		int error;
+	};
+
+	class ring;
+
+	batch_writer(batch_writer const&) = delete;
+	batch_writer & operator=(batch_writer const&) = delete;
+
+	void write_threads(std::vector<file *> const&);
+
+	std::size_t threads_;
+	std::vector<file> files_;
+	std::unique_ptr<ring> ring_;
+};
+
+// A streambuf printing straight into a shared mapping of a file of
+// the given size, usually the result of measure(). Where the file can
+// not be mapped it writes through a buffer instead. write() prints
+// once into a mapping it grows as needed.
+//
+//   mapped_writer out("foo.h", mapped_writer::measure(*hdr));
+//   std::ostream os(&out);
+//   hdr->print(os);
+//   out.close();
+class mapped_writer : public std::streambuf {
+public:
+	static std::size_t measure(src const&);
+	static void write(std::string const&, src const&);
+
+	mapped_writer(std::string const&, std::size_t);
+	~mapped_writer() override;
+
+	bool mapped() const;
+	// throws on write errors or if more than size bytes were printed
+	void close();
+
+protected:
+	int overflow(int) override;
+	int sync() override;
+
+private:
+	mapped_writer(mapped_writer const&) = delete;
+	mapped_writer & operator=(mapped_writer const&) = delete;
+
+	bool flush();
+	bool grow();
+	int finish();
+
+	int fd_;
+	std::size_t size_;
+	char * map_;
+	std::vector<char> buffer_;
+	bool grow_;
+	int error_;
+};
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_RAW_H
+#define LCCC_RAW_H
+
+#include <lccc/base.h>
+
+namespace lccc {
+
+// Verbatim text printed as is, but indented like any other node.
+class raw : public src {
+public:
+	using ptr_t = std::shared_ptr<raw>;
+
+	// not copied, the caller's memory has to outlive the node
+	static ptr_t make(char const*, std::size_t);
+	// copied once, the node owns the copy
+	static ptr_t make(std::string const&);
+	// a read-only mapping of the file, kept by the node
+	static ptr_t map(std::string const&);
+
+	std::ostream & print(std::ostream &) const;
+	bool hash(hasher &) const;
+	bool write(snapshot_writer &) const;
+	char const* data() const;
+	std::size_t size() const;
+
+private:
+	raw(std::shared_ptr<void const> const&, char const*, std::size_t);
+
+	std::shared_ptr<void const> owner_;
+	char const* data_;
+	std::size_t size_;
+};
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_RENDERER_H
+#define LCCC_RENDERER_H
+
+#include <lccc/base.h>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+namespace lccc {
+
+// Pulls the output of a tree in chunks. The tree is printed by a
+// thread of its own which blocks as soon as more than capacity bytes
+// wait to be taken, so memory stays bounded and the consumer sets the
+// pace:
+//
+//   renderer r(tree);
+//   while (auto chunk = r.next(64 * 1024)) {
+//       ::write(fd, chunk.data(), chunk.size());
+//   }
+class renderer {
+public:
+	class chunk {
+	public:
+		char const* data() const;
+		std::size_t size() const;
+		explicit operator bool() const;
+
+	private:
+		friend class renderer;
+
+		chunk(char const*, std::size_t);
+
+		char const* data_;
+		std::size_t size_;
+	};
+
+	explicit renderer(src::ptr_t const&, std::size_t capacity = 64 * 1024);
+	~renderer();
+
+	// up to max bytes, and no less than max or capacity, whichever is
+	// smaller, unless the tree is printed completely. The chunk stays
+	// valid until the next call.
+	chunk next(std::size_t max);
+
+private:
+	class buffer : public std::streambuf {
+	public:
+		explicit buffer(renderer &);
+		~buffer() override;
+
+	protected:
+		int overflow(int) override;
+		int sync() override;
+
+	private:
+		void flush();
+
+		renderer & owner_;
+		char area_[4096];
+	};
+
+	renderer(renderer const&) = delete;
+	renderer & operator=(renderer const&) = delete;
+
+	void run();
+	// throws once the renderer is destroyed to stop the print traversal
+	void push(char const*, std::size_t);
+
+	src::ptr_t root_;
+	std::size_t capacity_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::string pending_;
+	std::size_t offset_;
+	std::string current_;
+	bool started_;
+	bool done_;
+	bool cancel_;
+	std::exception_ptr error_;
+	std::thread thread_;
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_SNAPSHOT_H
+#define LCCC_SNAPSHOT_H
+
+#include <lccc/base.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace lccc {
+
+// A tree stored as flat tables in host byte order:
+//
+//   file_header | records | fields | children | strings
+//
+// Records refer to a contiguous range of fields and children, fields
+// refer to a range of the string table. A snapshot can be mapped from
+// a file and walked without building any node. print() writes the
+// records through the same routines the nodes print with, only enums
+// are rebuilt one at a time.
+class snapshot {
+public:
+	using ptr_t = std::shared_ptr<snapshot>;
+
+	enum class kind : std::uint8_t {
+		cc_block = 1,
+		cc_method,
+		cc_namespace,
+		cc_member,
+		cc_base_class,
+		cc_initializer,
+		cc_constructor,
+		cc_destructor,
+		cc_visibility,
+		cc_class,
+		cpp_define,
+		cpp_include,
+		cpp_condition,
+		cpp_guard,
+		header,
+		raw,
+		cc_array,
+		cc_enum,
+	};
+
+	struct file_header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t root;
+		std::uint32_t records;
+		std::uint32_t fields;
+		std::uint32_t children;
+		std::uint32_t strings;
+	};
+
+	struct record {
+		std::uint8_t type;
+		std::uint8_t flags;
+		std::uint16_t nfields;
+		std::uint32_t field;
+		std::uint32_t child;
+		std::uint32_t nchildren;
+	};
+
+	struct field {
+		std::uint32_t offset;
+		std::uint32_t size;
+	};
+
+	class node {
+	public:
+		std::uint32_t index() const;
+		kind type() const;
+		std::uint8_t flags() const;
+		std::size_t fields() const;
+		// points into the snapshot, valid as long as it is
+		text_ref field(std::size_t) const;
+		std::size_t children() const;
+		node child(std::size_t) const;
+
+	private:
+		friend class snapshot;
+
+		node(snapshot const*, std::uint32_t);
+		record const& rec() const;
+
+		snapshot const* snapshot_;
+		std::uint32_t index_;
+	};
+
+	static char const magic[8];
+	static std::uint32_t const version = 6;
+
+	static ptr_t open(std::string const&);
+	static ptr_t make(std::string const&);
+	static std::ostream & write(src const&, std::ostream &);
+
+	~snapshot();
+	node root() const;
+	node at(std::uint32_t) const;
+	std::size_t size() const;
+	src::ptr_t load() const;
+	src::ptr_t load(node const&) const;
+	std::ostream & print(std::ostream &) const;
+	std::ostream & print(node const&, std::ostream &) const;
+
+private:
+	snapshot();
+	void validate();
+
+	std::string buffer_;
+	void * map_;
+	std::size_t map_size_;
+	char const* data_;
+	std::size_t size_;
+	file_header const* header_;
+	record const* records_;
+	field const* fields_;
+	std::uint32_t const* children_;
+	char const* strings_;
+};
+
+// Nodes describe themselves through add() for each child and one call
+// of node() for their own record.
+class snapshot_writer {
+public:
+	snapshot_writer();
+	virtual ~snapshot_writer();
+
+	virtual std::uint32_t add(src const&);
+	virtual void node(snapshot::kind, std::uint8_t,
+		std::vector<std::string> const&,
+		std::vector<std::uint32_t> const&);
+	std::ostream & write(std::ostream &, std::uint32_t) const;
+	src const* source(std::uint32_t) const;
+
+private:
+	std::uint32_t intern(std::string const&);
+
+	std::vector<snapshot::record> records_;
+	std::vector<snapshot::field> fields_;
+	std::vector<std::uint32_t> children_;
+	std::string strings_;
+	std::unordered_map<std::string, std::uint32_t> interned_;
+	std::vector<src const*> sources_;
+	std::uint32_t last_;
+};
+
+}
+
+#endif
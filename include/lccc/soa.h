@@ -0,0 +1,62 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_SOA_H
+#define LCCC_SOA_H
+
+#include <lccc/cc.h>
+
+namespace lccc {
+
+// Generates a structure of arrays companion for a class: one aligned
+// column per data member, a proxy reference to a row, column access for
+// vectorized loops, reserve(), resize(), push_back() and erase_swap().
+// Columns are allocated in whole alignment blocks so loops may run over
+// the last block. Static members are skipped, the others have to be
+// trivially copyable and their names must not collide with the
+// generated ones. The generated code needs <cstddef>, <cstdlib>,
+// <cstring>, <new>, <type_traits> and posix_memalign() from <stdlib.h>.
+class cc_soa {
+public:
+	using ptr_t = std::shared_ptr<cc_soa>;
+
+	static ptr_t make(cc_class::ptr_t const&, std::string const&);
+	// throws std::invalid_argument unless a power of two of at least
+	// sizeof(void*), as posix_memalign() requires
+	void align(std::size_t);
+	// throws std::invalid_argument for colliding names
+	cc_class::ptr_t generate() const;
+
+private:
+	cc_soa(cc_class::ptr_t const&, std::string const&);
+
+	cc_class::ptr_t class_;
+	std::string name_;
+	std::size_t align_;
+};
+
+}
+
+#endif
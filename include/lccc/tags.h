@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LCCC_TAGS_H
+#define LCCC_TAGS_H
+
+#include <lccc/cc.h>
+#include <lccc/raw.h>
+
+namespace lccc {
+
+// Dense type tags for a class hierarchy, replacing dynamic_cast chains.
+// The root and the classes added are numbered depth first, so the tags
+// of a subtree form a contiguous range. apply() gives the root a tag_
+// member and a tag() getter, sets the tag at the start of every
+// constructor and adds a classof() range check to the derived classes.
+// Classes without copy or move operations get memberwise moves, and
+// copies as well after make_copyable(), so copying a sliced object sets
+// the tag of the copy and assignment keeps the tag of the target.
+// Without make_copyable() those classes are move-only, as any class with
+// a move-only member has to be. visit() calls a visitor with the object
+// cast to its concrete class by switching on the tag. The generated
+// code needs <cstdint>, <cstring> and <utility>.
+class cc_tags {
+public:
+	using ptr_t = std::shared_ptr<cc_tags>;
+
+	static ptr_t make(cc_class::ptr_t const&);
+	// classes derived from the root or from a class added before
+	void add(cc_class::ptr_t const&);
+	// generate copies next to the moves, for hierarchies whose members
+	// are all copyable
+	void make_copyable();
+	// enum class <root>_tag, printed before the root
+	cc_enum::ptr_t tags() const;
+	// modifies the classes, throws std::invalid_argument for defaulted
+	// constructors, constructors without a body, a defaulted assignment
+	// of the root and classes relying on the implicit copy constructor
+	// next to other copy or move operations
+	void apply() const;
+	// visit(<root>&, visitor) and visit(<root> const&, visitor), printed
+	// after the classes
+	raw::ptr_t visit() const;
+
+private:
+	struct entry {
+		cc_class::ptr_t cls;
+		// index of the last class of the subtree
+		std::size_t last;
+	};
+
+	cc_tags(cc_class::ptr_t const&);
+	std::vector<entry> order() const;
+	std::string tag(cc_class const&) const;
+
+	cc_class::ptr_t root_;
+	std::vector<cc_class::ptr_t> classes_;
+	bool copyable_;
+};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/output.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace lccc {
+
+async_writer::slot::slot(std::size_t index_, std::size_t size_)
+:
+	index(index_),
+	size(size_)
+{ }
+
+async_writer::async_writer(std::string const& path, std::size_t size, std::size_t count)
+:
+	fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)),
+	buffers_(std::max(count, std::size_t(2)), std::vector<char>(std::max(size, std::size_t(1)))),
+	current_(0),
+	busy_(false),
+	stop_(false),
+	error_(0)
+{
+	if (fd_ < 0) {
+		throw std::system_error(errno, std::system_category(), path);
+	}
+
+	for (std::size_t i(1); i < buffers_.size(); ++i) {
+		free_.push_back(i);
+	}
+	setp(buffers_[current_].data(), buffers_[current_].data() + buffers_[current_].size());
+	thread_ = std::thread(&async_writer::run, this);
+}
+
+async_writer::~async_writer()
+{
+	if (fd_ >= 0) {
+		drain();
+		stop();
+		::close(fd_);
+	}
+}
+
+void async_writer::close()
+{
+	if (fd_ < 0) {
+		return;
+	}
+
+	drain();
+	stop();
+	int err(error_);
+	if (::close(fd_) != 0 && !err) {
+		err = errno;
+	}
+	fd_ = -1;
+	if (err) {
+		throw std::system_error(err, std::system_category(), "lccc: async_writer");
+	}
+}
+
+void async_writer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	thread_.join();
+	setp(nullptr, nullptr);
+}
+
+void async_writer::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;) {
+		cond_.wait(lock, [this] { return stop_ || !full_.empty(); });
+		if (full_.empty()) {
+			break;
+		}
+
+		std::vector<slot> batch;
+		while (!full_.empty() && batch.size() < IOV_MAX) {
+			batch.push_back(full_.front());
+			full_.pop_front();
+		}
+		// after an error the remaining output is dropped
+		bool failed(error_ != 0);
+		busy_ = true;
+		lock.unlock();
+		if (!failed) {
+			write(batch);
+		}
+		lock.lock();
+		busy_ = false;
+		for (auto const& s: batch) {
+			free_.push_back(s.index);
+		}
+		cond_.notify_all();
+	}
+}
+
+void async_writer::write(std::vector<slot> const& batch)
+{
+	std::vector<struct iovec> iov;
+	for (auto const& s: batch) {
+		struct iovec v;
+		v.iov_base = buffers_[s.index].data();
+		v.iov_len = s.size;
+		iov.push_back(v);
+	}
+
+	std::size_t first(0);
+	while (first < iov.size()) {
+		auto res(::writev(fd_, &iov[first], iov.size() - first));
+		if (res < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			error_ = errno;
+			return;
+		}
+
+		std::size_t done(res);
+		while (first < iov.size() && done >= iov[first].iov_len) {
+			done -= iov[first].iov_len;
+			++first;
+		}
+		if (first < iov.size()) {
+			iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + done;
+			iov[first].iov_len -= done;
+		}
+	}
+}
+
+bool async_writer::submit()
+{
+	std::size_t size(pptr() - pbase());
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (error_) {
+		return false;
+	}
+	if (size == 0) {
+		return true;
+	}
+
+	full_.push_back(slot(current_, size));
+	cond_.notify_all();
+	cond_.wait(lock, [this] { return error_ || !free_.empty(); });
+	if (error_) {
+		setp(nullptr, nullptr);
+		return false;
+	}
+
+	current_ = free_.front();
+	free_.pop_front();
+	setp(buffers_[current_].data(), buffers_[current_].data() + buffers_[current_].size());
+	return true;
+}
+
+bool async_writer::drain()
+{
+	if (!pbase()) {
+		return false;
+	}
+	if (!submit()) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	cond_.wait(lock, [this] { return error_ || (full_.empty() && !busy_); });
+	return !error_;
+}
+
+int async_writer::overflow(int ch)
+{
+	if (!pbase() || !submit()) {
+		return traits_type::eof();
+	}
+	if (ch != traits_type::eof()) {
+		*pptr() = ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+int async_writer::sync()
+{
+	return drain() ? 0 : -1;
+}
+
+}
@@ -0,0 +1,431 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/output.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef LCCC_IO_URING
+#include <cstdio>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#endif
+
+namespace {
+
+int write_file(std::string const& path, std::string const& data)
+{
+	int fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+	if (fd < 0) {
+		return errno;
+	}
+
+	std::size_t done(0);
+	while (done < data.size()) {
+		auto res(::write(fd, data.data() + done, data.size() - done));
+		if (res < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			int err(errno);
+			::close(fd);
+			return err;
+		}
+		done += res;
+	}
+
+	return ::close(fd) == 0 ? 0 : errno;
+}
+
+}
+
+namespace lccc {
+
+#ifdef LCCC_IO_URING
+
+class batch_writer::ring {
+public:
+	static std::unique_ptr<ring> make();
+	~ring();
+
+	// files that could not be written keep their error for a retry
+	void write(std::vector<file *> const&);
+
+private:
+	static unsigned const slots = 64;
+
+	ring();
+	bool setup();
+	bool probe();
+	io_uring_sqe * sqe();
+	void submit(unsigned);
+
+	int fd_;
+	void * sq_map_;
+	std::size_t sq_size_;
+	void * cq_map_;
+	std::size_t cq_size_;
+	io_uring_sqe * sqes_;
+	std::size_t sqes_size_;
+	unsigned * sq_head_;
+	unsigned * sq_tail_;
+	unsigned * sq_mask_;
+	unsigned * sq_array_;
+	unsigned * cq_head_;
+	unsigned * cq_tail_;
+	unsigned * cq_mask_;
+	io_uring_cqe * cqes_;
+};
+
+std::unique_ptr<batch_writer::ring> batch_writer::ring::make()
+{
+	std::unique_ptr<ring> res(new ring());
+	try {
+		if (!res->setup() || !res->probe()) {
+			res.reset();
+		}
+	} catch (std::system_error const&) {
+		res.reset();
+	}
+	return res;
+}
+
+batch_writer::ring::ring()
+:
+	fd_(-1),
+	sq_map_(MAP_FAILED),
+	sq_size_(0),
+	cq_map_(MAP_FAILED),
+	cq_size_(0),
+	sqes_(static_cast<io_uring_sqe *>(MAP_FAILED)),
+	sqes_size_(0)
+{ }
+
+batch_writer::ring::~ring()
+{
+	if (sqes_ != MAP_FAILED) {
+		::munmap(sqes_, sqes_size_);
+	}
+	if (cq_map_ != MAP_FAILED && cq_map_ != sq_map_) {
+		::munmap(cq_map_, cq_size_);
+	}
+	if (sq_map_ != MAP_FAILED) {
+		::munmap(sq_map_, sq_size_);
+	}
+	if (fd_ >= 0) {
+		::close(fd_);
+	}
+}
+
+bool batch_writer::ring::setup()
+{
+	// before 5.15 opens ignore file_index and return a plain descriptor,
+	// and closes ignore it and close the descriptor in fd
+	utsname name;
+	unsigned major(0);
+	unsigned minor(0);
+	if (::uname(&name) != 0 || std::sscanf(name.release, "%u.%u", &major, &minor) != 2 ||
+	    major < 5 || (major == 5 && minor < 15)) {
+		return false;
+	}
+
+	io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	fd_ = ::syscall(__NR_io_uring_setup, slots * 3, &params);
+	if (fd_ < 0) {
+		return false;
+	}
+
+	sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool single(params.features & IORING_FEAT_SINGLE_MMAP);
+	if (single) {
+		sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+	}
+
+	sq_map_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+	if (sq_map_ == MAP_FAILED) {
+		return false;
+	}
+	cq_map_ = single ? sq_map_ : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+	if (cq_map_ == MAP_FAILED) {
+		return false;
+	}
+	sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+	sqes_ = static_cast<io_uring_sqe *>(::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+	if (sqes_ == MAP_FAILED) {
+		return false;
+	}
+
+	auto sq(static_cast<char *>(sq_map_));
+	sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+	sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+	sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+	sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+	auto cq(static_cast<char *>(cq_map_));
+	cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+	cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+	cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+	cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+	// a sparse table of direct descriptors, filled by the opens
+	std::vector<int> files(slots, -1);
+	return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_FILES,
+		files.data(), slots) == 0;
+}
+
+// one open into a direct descriptor and its close, for kernels which
+// claim a version they do not fully implement
+bool batch_writer::ring::probe()
+{
+	auto sqe_open(sqe());
+	sqe_open->opcode = IORING_OP_OPENAT;
+	sqe_open->flags = IOSQE_IO_LINK;
+	sqe_open->fd = AT_FDCWD;
+	sqe_open->addr = reinterpret_cast<std::uintptr_t>("/dev/null");
+	sqe_open->open_flags = O_RDONLY;
+	sqe_open->file_index = 1;
+	sqe_open->user_data = 0;
+
+	auto sqe_close(sqe());
+	sqe_close->opcode = IORING_OP_CLOSE;
+	sqe_close->file_index = 1;
+	sqe_close->user_data = 1;
+
+	int res[2] = {-1, -1};
+	unsigned seen(0);
+	while (seen < 2) {
+		submit(2 - seen);
+		auto head(*cq_head_);
+		auto tail(__atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE));
+		for (; head != tail; ++head, ++seen) {
+			auto const& cqe(cqes_[head & *cq_mask_]);
+			res[cqe.user_data & 1] = cqe.res;
+		}
+		__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+	}
+
+	if (res[0] > 0) {
+		::close(res[0]);
+	}
+	return res[0] == 0 && res[1] == 0;
+}
+
+io_uring_sqe * batch_writer::ring::sqe()
+{
+	auto tail(*sq_tail_);
+	auto index(tail & *sq_mask_);
+	auto res(&sqes_[index]);
+	std::memset(res, 0, sizeof(*res));
+	sq_array_[index] = index;
+	__atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+	return res;
+}
+
+void batch_writer::ring::submit(unsigned wait)
+{
+	for (;;) {
+		unsigned pending(*sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE));
+		if (::syscall(__NR_io_uring_enter, fd_, pending, wait,
+			IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+			return;
+		}
+		if (errno != EINTR) {
+			throw std::system_error(errno, std::system_category(), "lccc: io_uring_enter");
+		}
+	}
+}
+
+void batch_writer::ring::write(std::vector<file *> const& files)
+{
+	for (std::size_t first(0); first < files.size(); first += slots) {
+		auto count(std::min<std::size_t>(slots, files.size() - first));
+		for (unsigned slot(0); slot < count; ++slot) {
+			auto f(files[first + slot]);
+			auto sqe_open(sqe());
+			sqe_open->opcode = IORING_OP_OPENAT;
+			sqe_open->flags = IOSQE_IO_LINK;
+			sqe_open->fd = AT_FDCWD;
+			sqe_open->addr = reinterpret_cast<std::uintptr_t>(f->path.c_str());
+			sqe_open->len = 0666;
+			sqe_open->open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+			sqe_open->file_index = slot + 1;
+			sqe_open->user_data = (std::uint64_t(first + slot) << 2) | 0;
+
+			auto sqe_write(sqe());
+			sqe_write->opcode = IORING_OP_WRITE;
+			sqe_write->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+			sqe_write->fd = slot;
+			sqe_write->addr = reinterpret_cast<std::uintptr_t>(f->data.data());
+			sqe_write->len = f->data.size();
+			sqe_write->off = 0;
+			sqe_write->user_data = (std::uint64_t(first + slot) << 2) | 1;
+
+			auto sqe_close(sqe());
+			sqe_close->opcode = IORING_OP_CLOSE;
+			sqe_close->file_index = slot + 1;
+			sqe_close->user_data = (std::uint64_t(first + slot) << 2) | 2;
+		}
+
+		unsigned expected(count * 3);
+		unsigned seen(0);
+		while (seen < expected) {
+			submit(expected - seen);
+			auto head(*cq_head_);
+			auto tail(__atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE));
+			for (; head != tail; ++head, ++seen) {
+				auto const& cqe(cqes_[head & *cq_mask_]);
+				auto f(files[cqe.user_data >> 2]);
+				auto op(cqe.user_data & 3);
+				if (cqe.res < 0 && !f->error) {
+					f->error = -cqe.res;
+				} else if (op == 1 && std::size_t(cqe.res) != f->data.size() && !f->error) {
+					f->error = EIO;
+				}
+			}
+			__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+#else
+
+class batch_writer::ring {
+public:
+	static std::unique_ptr<ring> make()
+	{
+		return nullptr;
+	}
+
+	void write(std::vector<file *> const&)
+	{ }
+};
+
+#endif
+
+batch_writer::file::file(std::string const& path_, std::string const& data_)
+:
+	path(path_),
+	data(data_),
+	error(0)
+{ }
+
+batch_writer::batch_writer(std::size_t threads, backend use)
+:
+	threads_(std::max(threads, std::size_t(1))),
+	ring_(use == backend::io_uring ? ring::make() : nullptr)
+{ }
+
+batch_writer::~batch_writer()
+{ }
+
+void batch_writer::add(std::string const& path, std::string const& data)
+{
+	files_.push_back(file(path, data));
+}
+
+void batch_writer::add(std::string const& path, src const& node)
+{
+	std::stringstream out;
+	node.print(out);
+	add(path, out.str());
+}
+
+bool batch_writer::uses_io_uring() const
+{
+	return bool(ring_);
+}
+
+void batch_writer::write_threads(std::vector<file *> const& files)
+{
+	std::atomic<std::size_t> next(0);
+	auto work([&files, &next] {
+		for (auto i(next++); i < files.size(); i = next++) {
+			files[i]->error = write_file(files[i]->path, files[i]->data);
+		}
+	});
+
+	std::vector<std::thread> pool;
+	for (std::size_t i(1); i < std::min(threads_, files.size()); ++i) {
+		pool.emplace_back(work);
+	}
+	work();
+	for (auto & t: pool) {
+		t.join();
+	}
+}
+
+void batch_writer::flush()
+{
+	std::vector<file *> pending;
+	for (auto & f: files_) {
+		pending.push_back(&f);
+	}
+
+	// writes are limited to 32 bit lengths on the ring
+	if (ring_) {
+		std::vector<file *> small;
+		for (auto f: pending) {
+			if (f->data.size() < (1u << 30)) {
+				small.push_back(f);
+			}
+		}
+		ring_->write(small);
+
+		std::vector<file *> retry;
+		for (auto f: pending) {
+			if (f->data.size() >= (1u << 30) || f->error) {
+				f->error = 0;
+				retry.push_back(f);
+			}
+		}
+		pending.swap(retry);
+	}
+	write_threads(pending);
+
+	for (auto const& f: files_) {
+		if (f.error) {
+			auto err(f.error);
+			auto path(f.path);
+			files_.clear();
+			throw std::system_error(err, std::system_category(), path);
+		}
+	}
+	files_.clear();
+}
+
+}
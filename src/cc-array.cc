@@ -0,0 +1,416 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+char const decimal_digits[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+char const hex_digits[] = "0123456789abcdef";
+
+// writes the digits backwards, ending at end
+char * format_decimal(char * end, std::uint64_t value)
+{
+	while (value >= 100) {
+		auto pair(&decimal_digits[(value % 100) * 2]);
+		value /= 100;
+		*--end = pair[1];
+		*--end = pair[0];
+	}
+	if (value >= 10) {
+		auto pair(&decimal_digits[value * 2]);
+		*--end = pair[1];
+		*--end = pair[0];
+	} else {
+		*--end = char('0' + value);
+	}
+	return end;
+}
+
+char * format_hex(char * end, std::uint64_t value, std::size_t width)
+{
+	for (std::size_t i(0); i < width || value != 0; ++i) {
+		*--end = hex_digits[value & 0xf];
+		value >>= 4;
+	}
+	*--end = 'x';
+	*--end = '0';
+	return end;
+}
+
+// collects formatted elements into complete lines and hands them to
+// the stream in large blocks
+class table_writer {
+public:
+	table_writer(std::ostream & os, std::size_t wrap)
+	:
+		os_(os),
+		wrap_(wrap),
+		fill_(0),
+		column_(0)
+	{ }
+
+	~table_writer()
+	{
+		if (column_ != 0) {
+			buf_[fill_++] = '\n';
+		}
+		flush();
+	}
+
+	void put(char const* data, std::size_t size)
+	{
+		if (fill_ + size + 4 > sizeof(buf_)) {
+			flush();
+		}
+
+		if (column_ != 0 && column_ + 1 + size + 1 > wrap_) {
+			buf_[fill_++] = '\n';
+			column_ = 0;
+		}
+
+		if (column_ == 0) {
+			buf_[fill_++] = '\t';
+		} else {
+			buf_[fill_++] = ' ';
+			++column_;
+		}
+
+		std::memcpy(buf_ + fill_, data, size);
+		fill_ += size;
+		buf_[fill_++] = ',';
+		column_ += size + 1;
+	}
+
+private:
+	void flush()
+	{
+		os_.write(buf_, fill_);
+		fill_ = 0;
+	}
+
+	std::ostream & os_;
+	std::size_t wrap_;
+	std::size_t fill_;
+	std::size_t column_;
+	char buf_[64 * 1024];
+};
+
+template <typename T>
+bool is_negative(T value, std::true_type)
+{
+	return value < 0;
+}
+
+template <typename T>
+bool is_negative(T, std::false_type)
+{
+	return false;
+}
+
+template <typename T>
+T element_at(void const* data, std::size_t index)
+{
+	T value;
+	std::memcpy(&value, static_cast<char const*>(data) + index * sizeof(T), sizeof(T));
+	return value;
+}
+
+template <typename T>
+void print_integers(table_writer & out, void const* data, std::size_t size, bool hex)
+{
+	char buf[32];
+	char * end(buf + sizeof(buf));
+	for (std::size_t i(0); i < size; ++i) {
+		T value(element_at<T>(data, i));
+		// the magnitude of the minimum does not fit the signed literal
+		// types of its width, so -<magnitude> would be unsigned or narrow
+		if (std::is_signed<T>::value && value == std::numeric_limits<T>::min() &&
+		    (sizeof(T) == 8 || (hex && sizeof(T) >= sizeof(int)))) {
+			std::uint64_t max(std::numeric_limits<T>::max());
+			static char const tail[] = " - 1)";
+			char * last(end - (sizeof(tail) - 1));
+			std::memcpy(last, tail, sizeof(tail) - 1);
+			char * begin(hex ? format_hex(last, max, sizeof(T) * 2) : format_decimal(last, max));
+			*--begin = '-';
+			*--begin = '(';
+			out.put(begin, end - begin);
+			continue;
+		}
+
+		bool negative(is_negative(value, std::is_signed<T>()));
+		std::uint64_t magnitude(negative ?
+			0 - std::uint64_t(std::int64_t(value)) : std::uint64_t(value));
+
+		char * begin;
+		if (hex) {
+			begin = format_hex(end, magnitude, sizeof(T) * 2);
+		} else if (magnitude > std::uint64_t(std::numeric_limits<std::int64_t>::max())) {
+			end[-1] = 'u';
+			begin = format_decimal(end - 1, magnitude);
+		} else {
+			begin = format_decimal(end, magnitude);
+		}
+
+		if (negative) {
+			*--begin = '-';
+		}
+		out.put(begin, end - begin);
+	}
+}
+
+template <typename T>
+void print_floats(table_writer & out, void const* data, std::size_t size)
+{
+	std::string const limits(sizeof(T) == 4 ?
+		"std::numeric_limits<float>::" : "std::numeric_limits<double>::");
+	std::string const inf(limits + "infinity()");
+	std::string const neg_inf("-" + inf);
+	std::string const nan(limits + "quiet_NaN()");
+
+	char buf[64];
+	for (std::size_t i(0); i < size; ++i) {
+		double value(element_at<T>(data, i));
+		if (std::isnan(value)) {
+			out.put(nan.data(), nan.size());
+			continue;
+		} else if (std::isinf(value)) {
+			auto const& s(value < 0 ? neg_inf : inf);
+			out.put(s.data(), s.size());
+			continue;
+		}
+
+		int len(std::snprintf(buf, sizeof(buf) - 4, "%.*g",
+			std::numeric_limits<T>::max_digits10, value));
+		bool fraction(false);
+		for (int n(0); n < len; ++n) {
+			if (buf[n] == ',') {
+				buf[n] = '.';
+			}
+			fraction |= buf[n] == '.' || buf[n] == 'e';
+		}
+		if (!fraction) {
+			buf[len++] = '.';
+			buf[len++] = '0';
+		}
+		if (sizeof(T) == 4) {
+			buf[len++] = 'f';
+		}
+		out.put(buf, len);
+	}
+}
+
+}
+
+namespace lccc {
+
+cc_array::cc_array(std::string const& type, std::string const& name, element elem,
+	std::shared_ptr<void const> const& owner, void const* data, std::size_t size)
+:
+	type_(type),
+	name_(name),
+	element_(elem),
+	owner_(owner),
+	data_(data),
+	size_(size),
+	static_(false),
+	constexpr_(false),
+	hex_(false),
+	align_(0),
+	wrap_(72)
+{
+	if (size_ == 0) {
+		throw std::invalid_argument("lccc: empty array " + name_);
+	}
+}
+
+void cc_array::make_static()
+{
+	static_ = true;
+}
+
+void cc_array::make_constexpr()
+{
+	constexpr_ = true;
+}
+
+void cc_array::make_hex()
+{
+	hex_ = true;
+}
+
+void cc_array::align(std::size_t alignment)
+{
+	align_ = alignment;
+}
+
+void cc_array::wrap(std::size_t columns)
+{
+	wrap_ = columns;
+}
+
+std::ostream & cc_array::print(std::ostream & os) const
+{
+	return format(os, type_, name_, element_, data_, size_, flags(), align_, wrap_);
+}
+
+std::ostream & cc_array::format(std::ostream & os, text_ref type, text_ref name,
+	element elem, void const* data, std::size_t size, std::uint8_t flags,
+	std::size_t align, std::size_t wrap)
+{
+	if (align != 0) {
+		os << "alignas(" << align << ") ";
+	}
+	if (flags & 1) {
+		os << "static ";
+	}
+	if (flags & 2) {
+		os << "constexpr ";
+	}
+	os << type << " " << name << "[" << size << "] = {\n";
+
+	{
+		table_writer out(os, wrap);
+		bool hex(flags & 4);
+		switch (elem) {
+		case element::int8:
+			print_integers<std::int8_t>(out, data, size, hex);
+			break;
+		case element::int16:
+			print_integers<std::int16_t>(out, data, size, hex);
+			break;
+		case element::int32:
+			print_integers<std::int32_t>(out, data, size, hex);
+			break;
+		case element::int64:
+			print_integers<std::int64_t>(out, data, size, hex);
+			break;
+		case element::uint8:
+			print_integers<std::uint8_t>(out, data, size, hex);
+			break;
+		case element::uint16:
+			print_integers<std::uint16_t>(out, data, size, hex);
+			break;
+		case element::uint32:
+			print_integers<std::uint32_t>(out, data, size, hex);
+			break;
+		case element::uint64:
+			print_integers<std::uint64_t>(out, data, size, hex);
+			break;
+		case element::float32:
+			print_floats<float>(out, data, size);
+			break;
+		case element::float64:
+			print_floats<double>(out, data, size);
+			break;
+		}
+	}
+
+	os << "};\n";
+	return os;
+}
+
+std::size_t cc_array::width(element type)
+{
+	switch (type) {
+	case element::int8:
+	case element::uint8:
+		return 1;
+	case element::int16:
+	case element::uint16:
+		return 2;
+	case element::int32:
+	case element::uint32:
+	case element::float32:
+		return 4;
+	case element::int64:
+	case element::uint64:
+	case element::float64:
+		return 8;
+	}
+	return 0;
+}
+
+bool cc_array::hash(hasher & h) const
+{
+	h.add("cc_array").add(type_).add(name_).add(std::uint64_t(element_))
+		.add(static_).add(constexpr_).add(hex_)
+		.add(std::uint64_t(align_)).add(std::uint64_t(wrap_))
+		.add(static_cast<char const*>(data_), size_ * width(element_));
+	return true;
+}
+
+bool cc_array::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_array, flags(), {
+		type_, name_,
+		std::to_string(unsigned(element_)),
+		std::to_string(align_),
+		std::to_string(wrap_),
+		std::string(static_cast<char const*>(data_), size_ * width(element_)),
+	}, {});
+	return true;
+}
+
+std::uint8_t cc_array::flags() const
+{
+	return (static_ ? 1 : 0) | (constexpr_ ? 2 : 0) | (hex_ ? 4 : 0);
+}
+
+std::string cc_array::name() const
+{
+	return name_;
+}
+
+cc_array::element cc_array::type() const
+{
+	return element_;
+}
+
+void const* cc_array::data() const
+{
+	return data_;
+}
+
+std::size_t cc_array::size() const
+{
+	return size_;
+}
+
+}
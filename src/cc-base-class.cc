@@ -24,12 +24,32 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
 std::ostream & cc_base_class::initializer::print(std::ostream & os) const
 {
-	return os << name_ << "(" << init_ << ")";
+	return format(os, name_, init_);
+}
+
+std::ostream & cc_base_class::initializer::format(std::ostream & os, text_ref name,
+	text_ref init)
+{
+	return os << name << "(" << init << ")";
+}
+
+bool cc_base_class::initializer::hash(hasher & h) const
+{
+	h.add("cc_base_class::initializer").add(name_).add(init_);
+	return true;
+}
+
+bool cc_base_class::initializer::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_initializer, 0, {name_, init_}, {});
+	return true;
 }
 
 cc_base_class::initializer::initializer(std::string const& name, std::string const& init)
@@ -43,6 +63,18 @@ std::ostream & cc_base_class::print(std::ostream & os) const
 	return os << name_;
 }
 
+bool cc_base_class::hash(hasher & h) const
+{
+	h.add("cc_base_class").add(name_);
+	return true;
+}
+
+bool cc_base_class::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_base_class, 0, {name_}, {});
+	return true;
+}
+
 cc_base_class::ptr_t cc_base_class::make(std::string const& name)
 {
 	return ptr_t(new cc_base_class(name));
@@ -58,4 +90,9 @@ cc_base_class::cc_base_class(std::string const& name)
 	name_(name)
 { }
 
+std::string cc_base_class::name() const
+{
+	return name_;
+}
+
 }
@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 #include <lccc/indent.h>
 
 namespace lccc {
@@ -37,19 +39,42 @@ cc_block::ptr_t cc_block::make()
 }
 
 std::ostream & cc_block::print(std::ostream & os) const
+{
+	return format(os, source_.str());
+}
+
+std::ostream & cc_block::format(std::ostream & os, text_ref source)
 {
 	os << "{\n";
 	{
 		indent ind(os);
-		os << source_.str();
+		os << source;
 	}
 	os << "}\n";
 	return os;
 }
 
+bool cc_block::hash(hasher & h) const
+{
+	h.add("cc_block").add(source_.str());
+	return true;
+}
+
+bool cc_block::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_block, 0, {source_.str()}, {});
+	return true;
+}
+
 std::ostream & cc_block::src()
 {
 	return source_;
 }
 
+void cc_block::prepend(std::string const& text)
+{
+	source_.str(text + source_.str());
+	source_.seekp(0, std::ios::end);
+}
+
 }
@@ -24,8 +24,44 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 #include <lccc/indent.h>
 
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string word_type(std::size_t bits)
+{
+	return bits <= 8 ? "std::uint8_t" : bits <= 16 ? "std::uint16_t" :
+		bits <= 32 ? "std::uint32_t" : "std::uint64_t";
+}
+
+std::string mask(std::size_t bits)
+{
+	std::ostringstream os;
+	os << "0x" << std::hex << (bits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1)
+		<< (bits > 32 ? "ull" : "u");
+	return os.str();
+}
+
+// the condition of a noexcept specification, every type has to pass
+// the trait
+std::string all_of(std::string const& trait, std::vector<std::string> const& types)
+{
+	std::string res;
+	for (auto const& type: types) {
+		res += (res.empty() ? "" : " && ") + trait + "<" + type + ">::value";
+	}
+	return res;
+}
+
+}
+
 namespace lccc {
 
 cc_class::constructor::constructor(std::string const& name)
@@ -42,24 +78,37 @@ cc_class::constructor::add(cc_base_class::initializer::ptr_t const& init)
 
 std::ostream & cc_class::constructor::print(std::ostream & os) const
 {
-	os << name_;
-	os << "(" << (src_ ? named_args() : args()) << ")";
-	if (src_) {
+	return format(os, declare(), initializers_.size(),
+		[this, &os](std::size_t i) { initializers_[i]->print(os); }, body_printer(os));
+}
+
+std::ostream & cc_class::constructor::format(std::ostream & os, declaration const& decl,
+	std::size_t initializers, std::function<void(std::size_t)> const& initializer,
+	body_t const& body)
+{
+	format_attributes(os, decl);
+	format_specifiers(os, decl);
+	os << decl.name;
+	format_args(os, decl, bool(body));
+	format_exceptions(os, decl);
+	if (*special(decl)) {
+		os << special(decl) << ";";
+	} else if (body) {
 		os << "\n";
-		if (!initializers_.empty()) {
+		if (initializers != 0) {
 			os << ":\n";
 			{
 				indent ind(os);
 				std::string sep;
-				for (auto init: initializers_) {
+				for (std::size_t i(0); i < initializers; ++i) {
 					os << sep;
-					init->print(os);
+					initializer(i);
 					sep = ",\n";
 				}
 			}
 			os << "\n";
 		}
-		src_->print(os);
+		body();
 	} else {
 		os << ";";
 	}
@@ -67,19 +116,57 @@ std::ostream & cc_class::constructor::print(std::ostream & os) const
 	return os;
 }
 
+bool cc_class::constructor::hash(hasher & h) const
+{
+	h.add("cc_class::constructor").add(std::uint64_t(initializers_.size()));
+	for (auto init: initializers_) {
+		h.add(*init);
+	}
+
+	return hash_base(h);
+}
+
+bool cc_class::constructor::write(snapshot_writer & w) const
+{
+	std::vector<std::uint32_t> children;
+	for (auto init: initializers_) {
+		children.push_back(w.add(*init));
+	}
+	for (auto child: write_src(w)) {
+		children.push_back(child);
+	}
+	w.node(snapshot::kind::cc_constructor, 0, base_fields(), children);
+	return true;
+}
+
 cc_class::destructor::destructor(std::string const& name)
 :
 	cc_method_base(name),
-	virtual_(false)
+	virtual_(false),
+	final_(false)
 { }
 
 std::ostream & cc_class::destructor::print(std::ostream & os) const
 {
-	os << (virtual_ ? "virtual " : "");
-	os << "~" << name_ << "()";
-	if (src_) {
+	return format(os, declare(), flags(), body_printer(os));
+}
+
+std::ostream & cc_class::destructor::format(std::ostream & os, declaration const& decl,
+	std::uint8_t flags, body_t const& body)
+{
+	format_attributes(os, decl);
+	os << (flags & 1 ? "virtual " : "");
+	format_specifiers(os, decl);
+	os << "~" << decl.name << "()";
+	format_exceptions(os, decl);
+	if (flags & 2) {
+		os << " final";
+	}
+	if (*special(decl)) {
+		os << special(decl) << ";";
+	} else if (body) {
 		os << "\n";
-		src_->print(os);
+		body();
 	} else {
 		os << ";";
 	}
@@ -87,11 +174,38 @@ std::ostream & cc_class::destructor::print(std::ostream & os) const
 	return os;
 }
 
+bool cc_class::destructor::hash(hasher & h) const
+{
+	h.add("cc_class::destructor").add(virtual_).add(final_);
+	return hash_base(h);
+}
+
+bool cc_class::destructor::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_destructor, flags(), base_fields(), write_src(w));
+	return true;
+}
+
+std::uint8_t cc_class::destructor::flags() const
+{
+	return (virtual_ ? 1 : 0) | (final_ ? 2 : 0);
+}
+
 void cc_class::destructor::make_virtual()
 {
 	virtual_ = true;
 }
 
+void cc_class::destructor::make_final()
+{
+	final_ = true;
+}
+
+bool cc_class::destructor::is_virtual() const
+{
+	return virtual_;
+}
+
 cc_class::visibility::visibility(std::string const& keyword)
 :
 	keyword_(keyword)
@@ -99,14 +213,187 @@ cc_class::visibility::visibility(std::string const& keyword)
 
 std::ostream & cc_class::visibility::print(std::ostream & os) const
 {
-	if (!content_.empty()) {
-		os << keyword_ << ":\n";
+	return format(os, keyword_, content_.empty(), [this, &os] { print_content(os); });
+}
+
+std::ostream & cc_class::visibility::format(std::ostream & os, text_ref keyword, bool empty,
+	std::function<void()> const& content)
+{
+	if (!empty) {
+		os << keyword << ":\n";
 		indent ind(os);
-		print_content(os);
+		content();
 	}
 	return os;
 }
 
+bool cc_class::visibility::hash(hasher & h) const
+{
+	h.add("cc_class::visibility").add(keyword_);
+	return hash_content(h);
+}
+
+bool cc_class::visibility::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_visibility, 0, {keyword_}, write_content(w));
+	return true;
+}
+
+std::vector<cc_member::ptr_t> cc_class::visibility::members() const
+{
+	std::vector<cc_member::ptr_t> res;
+	for (auto const& src: content_) {
+		if (auto member = std::dynamic_pointer_cast<cc_member>(src)) {
+			res.push_back(member);
+		}
+	}
+	return res;
+}
+
+std::vector<cc_method::ptr_t> cc_class::visibility::methods() const
+{
+	std::vector<cc_method::ptr_t> res;
+	for (auto const& src: content_) {
+		if (auto method = std::dynamic_pointer_cast<cc_method>(src)) {
+			res.push_back(method);
+		}
+	}
+	return res;
+}
+
+std::vector<cc_class::constructor::ptr_t> cc_class::visibility::constructors() const
+{
+	std::vector<constructor::ptr_t> res;
+	for (auto const& src: content_) {
+		if (auto ctor = std::dynamic_pointer_cast<constructor>(src)) {
+			res.push_back(ctor);
+		}
+	}
+	return res;
+}
+
+// members keep the positions of members, other content and static
+// members stay in place
+void cc_class::visibility::layout()
+{
+	auto is_static = [](src::ptr_t const& node) {
+		auto member(std::dynamic_pointer_cast<cc_member>(node));
+		return member && member->is_static();
+	};
+	std::vector<cc_member::ptr_t> sorted;
+	for (auto const& member: members()) {
+		if (!is_static(member)) {
+			sorted.push_back(member);
+		}
+	}
+	auto rank = [](cc_member::ptr_t const& m) {
+		return m->hot() ? 0 : m->cold() ? 2 : 1;
+	};
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[&rank](cc_member::ptr_t const& l, cc_member::ptr_t const& r) {
+			if (rank(l) != rank(r)) {
+				return rank(l) < rank(r);
+			}
+			return l->alignment() > r->alignment();
+	});
+
+	auto next(sorted.begin());
+	for (auto & src: content_) {
+		if (std::dynamic_pointer_cast<cc_member>(src) && !is_static(src)) {
+			src = *next++;
+		}
+	}
+}
+
+// packed members are assigned to the first word with room, the words
+// take the place of the first packed member
+void cc_class::visibility::pack()
+{
+	struct field {
+		std::size_t word;
+		std::size_t shift;
+	};
+
+	std::vector<std::size_t> used;
+	std::map<cc_member const*, field> fields;
+	for (auto const& member: members()) {
+		auto bits(member->bits());
+		if (bits == 0) {
+			continue;
+		} else if (bits > 64) {
+			throw std::invalid_argument("lccc: can not pack member " + member->name());
+		}
+
+		std::size_t word(0);
+		while (word < used.size() && used[word] + bits > 64) {
+			++word;
+		}
+		if (word == used.size()) {
+			used.push_back(0);
+		}
+		fields[member.get()] = field{word, used[word]};
+		used[word] += bits;
+	}
+
+	if (fields.empty()) {
+		return;
+	}
+
+	std::vector<std::string> words;
+	for (std::size_t i(0); i < used.size(); ++i) {
+		words.push_back(keyword_ + "_bits" + std::to_string(i) + "_");
+	}
+
+	std::vector<src::ptr_t> content;
+	bool placed(false);
+	for (auto const& src: content_) {
+		auto member(std::dynamic_pointer_cast<cc_member>(src));
+		auto it(member ? fields.find(member.get()) : fields.end());
+		if (it == fields.end()) {
+			content.push_back(src);
+			continue;
+		}
+
+		if (!placed) {
+			for (std::size_t i(0); i < words.size(); ++i) {
+				content.push_back(cc_member::make(word_type(used[i]), words[i]));
+			}
+			placed = true;
+		}
+
+		auto const& word(words[it->second.word]);
+		auto type(word_type(used[it->second.word]));
+		auto shift(std::to_string(it->second.shift));
+		auto bits(mask(member->bits()));
+
+		auto get(cc_method::make(member->type(), member->name()));
+		get->make_const();
+		auto & body(get->define(cc_block::make())->src());
+		if (member->is_signed() && member->bits() < 64) {
+			// flipping the sign bit and subtracting it extends the sign
+			auto sign(std::uint64_t(1) << (member->bits() - 1));
+			body
+				<< "return static_cast<" << member->type() << ">(static_cast<std::int64_t>(((" << word
+				<< " >> " << shift << ") & " << bits << ") ^ " << sign << "ull) - "
+				<< sign << "ll);\n";
+		} else {
+			body
+				<< "return static_cast<" << member->type() << ">((" << word << " >> "
+				<< shift << ") & " << bits << ");\n";
+		}
+		content.push_back(get);
+
+		auto set(cc_method::make("void", member->name()));
+		set->add_arg(member->type(), "value");
+		set->define(cc_block::make())->src()
+			<< word << " = static_cast<" << type << ">((" << word
+			<< " & ~(static_cast<" << type << ">(" << bits << ") << " << shift << ")) |\n"
+			<< "\t((static_cast<" << type << ">(value) & " << bits << ") << " << shift << "));\n";
+		content.push_back(set);
+	}
+	content_.swap(content);
+}
+
 cc_method::ptr_t
 cc_class::visibility::add(cc_method::ptr_t const& src)
 {
@@ -135,6 +422,42 @@ cc_class::visibility::add(destructor::ptr_t const& src)
 	return src;
 }
 
+lazy::ptr_t
+cc_class::visibility::add(lazy::ptr_t const& src)
+{
+	content_.push_back(src);
+	return src;
+}
+
+raw::ptr_t
+cc_class::visibility::add(raw::ptr_t const& src)
+{
+	content_.push_back(src);
+	return src;
+}
+
+cc_array::ptr_t
+cc_class::visibility::add(cc_array::ptr_t const& src)
+{
+	content_.push_back(src);
+	return src;
+}
+
+cc_enum::ptr_t
+cc_class::visibility::add(cc_enum::ptr_t const& src)
+{
+	src->member_ = true;
+	content_.push_back(src);
+	return src;
+}
+
+cc_class::ptr_t
+cc_class::visibility::add(cc_class::ptr_t const& src)
+{
+	content_.push_back(src);
+	return src;
+}
+
 cc_class::ptr_t cc_class::make(std::string const& name)
 {
 	return ptr_t(new cc_class(name));
@@ -143,6 +466,7 @@ cc_class::ptr_t cc_class::make(std::string const& name)
 cc_class::cc_class(std::string const& name)
 :
 	name_(name),
+	final_(false),
 	public_(new visibility("public")),
 	protected_(new visibility("protected")),
 	private_(new visibility("private"))
@@ -152,11 +476,89 @@ cc_class::cc_class(std::string const& name)
 	content_.push_back(private_);
 }
 
+void cc_class::make_final()
+{
+	final_ = true;
+}
+
+void cc_class::add_template_parameter(std::string const& parameter)
+{
+	template_parameters_.push_back(parameter);
+}
+
 cc_class::constructor::ptr_t cc_class::make_constructor() const
 {
 	return constructor::ptr_t(new constructor(name_));
 }
 
+cc_class::constructor::ptr_t cc_class::make_move_constructor() const
+{
+	auto members(data_members());
+	auto ctor(make_constructor());
+	ctor->add_arg(name_ + "&&", base_classes_.empty() && members.empty() ? "" : "other");
+	ctor->make_noexcept(all_of("std::is_nothrow_move_constructible", moved_types()));
+	for (auto base: base_classes_) {
+		ctor->add(base->make_initializer("std::move(other)"));
+	}
+	for (auto const& data: members) {
+		auto name(data.first->name());
+		ctor->add(cc_base_class::make(name)->make_initializer("std::move(other." + name + ")"));
+	}
+	ctor->define(cc_block::make());
+	return ctor;
+}
+
+cc_method::ptr_t cc_class::make_move_assignment() const
+{
+	auto members(data_members());
+	auto assign(cc_method::make(name_ + "&", "operator="));
+	assign->add_arg(name_ + "&&", base_classes_.empty() && members.empty() ? "" : "other");
+	assign->make_noexcept(all_of("std::is_nothrow_move_assignable", moved_types()));
+	auto & body(assign->define(cc_block::make())->src());
+	for (auto base: base_classes_) {
+		body << base->name() << "::operator=(std::move(other));\n";
+	}
+	for (auto const& data: members) {
+		auto name(data.first->name());
+		body << name << " = std::move(other." << name << ");\n";
+	}
+	body << "return *this;\n";
+	return assign;
+}
+
+cc_class::constructor::ptr_t cc_class::make_copy_constructor() const
+{
+	auto members(data_members());
+	auto ctor(make_constructor());
+	ctor->add_arg(name_ + " const&", base_classes_.empty() && members.empty() ? "" : "other");
+	for (auto base: base_classes_) {
+		ctor->add(base->make_initializer("other"));
+	}
+	for (auto const& data: members) {
+		auto name(data.first->name());
+		ctor->add(cc_base_class::make(name)->make_initializer("other." + name));
+	}
+	ctor->define(cc_block::make());
+	return ctor;
+}
+
+cc_method::ptr_t cc_class::make_copy_assignment() const
+{
+	auto members(data_members());
+	auto assign(cc_method::make(name_ + "&", "operator="));
+	assign->add_arg(name_ + " const&", base_classes_.empty() && members.empty() ? "" : "other");
+	auto & body(assign->define(cc_block::make())->src());
+	for (auto base: base_classes_) {
+		body << base->name() << "::operator=(other);\n";
+	}
+	for (auto const& data: members) {
+		auto name(data.first->name());
+		body << name << " = other." << name << ";\n";
+	}
+	body << "return *this;\n";
+	return assign;
+}
+
 cc_class::destructor::ptr_t cc_class::make_destructor() const
 {
 	return destructor::ptr_t(new destructor(name_));
@@ -179,15 +581,34 @@ cc_class::visibility::ptr_t cc_class::vprotected() const
 
 std::ostream & cc_class::print(std::ostream & os) const
 {
-	os << "class " << name_ << " ";
-	if (!base_classes_.empty()) {
+	std::vector<text_ref> parameters(template_parameters_.begin(), template_parameters_.end());
+	return format(os, name_, final_, parameters, base_classes_.size(),
+		[this, &os](std::size_t i) { base_classes_[i]->print(os); },
+		[this, &os] { print_content(os); });
+}
+
+std::ostream & cc_class::format(std::ostream & os, text_ref name, bool final,
+	std::vector<text_ref> const& parameters, std::size_t bases,
+	std::function<void(std::size_t)> const& base, std::function<void()> const& content)
+{
+	if (!parameters.empty()) {
+		os << "template <";
+		std::string sep;
+		for (auto const& parameter: parameters) {
+			os << sep << parameter;
+			sep = ", ";
+		}
+		os << ">\n";
+	}
+	os << "class " << name << (final ? " final " : " ");
+	if (bases != 0) {
 		os << ":\n";
 		{
 			indent ind(os);
 			std::string sep;
-			for (auto base: base_classes_) {
+			for (std::size_t i(0); i < bases; ++i) {
 				os << sep << "public ";
-				base->print(os);
+				base(i);
 				sep = ",\n";
 			}
 		}
@@ -195,11 +616,40 @@ std::ostream & cc_class::print(std::ostream & os) const
 	}
 
 	os << "{\n";
-	print_content(os);
+	content();
 	os << "};\n";
 	return os;
 }
 
+bool cc_class::hash(hasher & h) const
+{
+	h.add("cc_class").add(name_).add(final_).add(std::uint64_t(template_parameters_.size()));
+	for (auto const& parameter: template_parameters_) {
+		h.add(parameter);
+	}
+	h.add(std::uint64_t(base_classes_.size()));
+	for (auto base: base_classes_) {
+		h.add(*base);
+	}
+
+	return hash_content(h);
+}
+
+bool cc_class::write(snapshot_writer & w) const
+{
+	std::vector<std::uint32_t> children;
+	for (auto base: base_classes_) {
+		children.push_back(w.add(*base));
+	}
+	for (auto child: write_content(w)) {
+		children.push_back(child);
+	}
+	std::vector<std::string> fields{name_};
+	fields.insert(fields.end(), template_parameters_.begin(), template_parameters_.end());
+	w.node(snapshot::kind::cc_class, final_ ? 1 : 0, fields, children);
+	return true;
+}
+
 cc_base_class::ptr_t
 cc_class::add(cc_base_class::ptr_t const& base)
 {
@@ -207,9 +657,618 @@ cc_class::add(cc_base_class::ptr_t const& base)
 	return base;
 }
 
+std::vector<cc_base_class::ptr_t> const& cc_class::bases() const
+{
+	return base_classes_;
+}
+
+bool cc_class::replace(std::string const& name, cc_base_class::ptr_t const& base)
+{
+	for (auto & old: base_classes_) {
+		if (old->name() == name) {
+			old = base;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<cc_method::ptr_t> cc_class::methods() const
+{
+	std::vector<cc_method::ptr_t> res;
+	for (auto vis: {public_, protected_, private_}) {
+		auto methods(vis->methods());
+		res.insert(res.end(), methods.begin(), methods.end());
+	}
+	return res;
+}
+
+std::vector<cc_class::constructor::ptr_t> cc_class::constructors() const
+{
+	std::vector<constructor::ptr_t> res;
+	for (auto vis: {public_, protected_, private_}) {
+		auto ctors(vis->constructors());
+		res.insert(res.end(), ctors.begin(), ctors.end());
+	}
+	return res;
+}
+
+std::vector<cc_member::ptr_t> cc_class::members() const
+{
+	std::vector<cc_member::ptr_t> res;
+	for (auto vis: {public_, protected_, private_}) {
+		auto members(vis->members());
+		res.insert(res.end(), members.begin(), members.end());
+	}
+	return res;
+}
+
+bool cc_class::has_vptr() const
+{
+	for (auto vis: {public_, protected_, private_}) {
+		for (auto const& src: vis->content_) {
+			auto method(std::dynamic_pointer_cast<cc_method>(src));
+			auto dtor(std::dynamic_pointer_cast<destructor>(src));
+			if ((method && method->is_virtual()) || (dtor && dtor->is_virtual())) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+cc_class::layout_info cc_class::estimate() const
+{
+	if (!base_classes_.empty()) {
+		throw std::invalid_argument("lccc: no layout estimate for derived class " + name_);
+	}
+
+	layout_info res{0, 1, 0};
+	std::size_t used(0);
+	if (has_vptr()) {
+		res.size = res.alignment = used = sizeof(void *);
+	}
+
+	for (auto const& data: data_members()) {
+		auto const& member(data.first);
+		if (member->size() == 0) {
+			throw std::invalid_argument("lccc: unknown size of member " + member->name());
+		}
+		auto align(member->alignment());
+		res.size = (res.size + align - 1) / align * align + member->size();
+		res.alignment = std::max(res.alignment, align);
+		used += member->size();
+	}
+
+	res.size = std::max<std::size_t>(1, (res.size + res.alignment - 1) / res.alignment * res.alignment);
+	res.padding = res.size - std::min(res.size, used);
+	return res;
+}
+
+cc_class::layout_info cc_class::layout()
+{
+	for (auto vis: {public_, protected_, private_}) {
+		vis->layout();
+	}
+	return estimate();
+}
+
+void cc_class::pack()
+{
+	for (auto vis: {public_, protected_, private_}) {
+		vis->pack();
+	}
+}
+
+void cc_class::pool(std::size_t objects)
+{
+	if (objects == 0) {
+		throw std::invalid_argument("lccc: empty pool blocks for " + name_);
+	}
+
+	auto alloc(public_->add(cc_method::make("void*", "operator new")));
+	alloc->make_static();
+	alloc->add_arg("std::size_t", "size");
+	alloc->define(cc_block::make())->src()
+		<< "if (size != sizeof(" << name_ << ")) {\n"
+		<< "\treturn ::operator new(size);\n"
+		<< "}\n"
+		<< "auto & free(pool_free());\n"
+		<< "if (free == nullptr) {\n"
+		<< "\tfree = pool_grow();\n"
+		<< "}\n"
+		<< "auto slot(free);\n"
+		<< "free = slot->next;\n"
+		<< "return slot;\n";
+
+	auto release(public_->add(cc_method::make("void", "operator delete")));
+	release->make_static();
+	release->make_noexcept();
+	release->add_arg("void*", "ptr");
+	release->add_arg("std::size_t", "size");
+	release->define(cc_block::make())->src()
+		<< "if (ptr == nullptr) {\n"
+		<< "\treturn;\n"
+		<< "}\n"
+		<< "if (size != sizeof(" << name_ << ")) {\n"
+		<< "\t::operator delete(ptr);\n"
+		<< "\treturn;\n"
+		<< "}\n"
+		<< "auto slot(static_cast<pool_slot*>(ptr));\n"
+		<< "auto & free(pool_free());\n"
+		<< "slot->next = free;\n"
+		<< "free = slot;\n";
+
+	// the class specific operators hide the global placement forms
+	auto place(public_->add(cc_method::make("void*", "operator new")));
+	place->make_static();
+	place->make_noexcept();
+	place->add_arg("std::size_t");
+	place->add_arg("void*", "where");
+	place->define(cc_block::make())->src() << "return where;\n";
+	auto unplace(public_->add(cc_method::make("void", "operator delete")));
+	unplace->make_static();
+	unplace->make_noexcept();
+	unplace->add_arg("void*");
+	unplace->add_arg("void*");
+	unplace->define(cc_block::make());
+
+	public_->add(raw::make(
+		"template <typename... Args>\n"
+		"static std::unique_ptr<" + name_ + "> make_pooled(Args&&... args)\n"
+		"{\n"
+		"\treturn std::unique_ptr<" + name_ + ">(new " + name_ + "(std::forward<Args>(args)...));\n"
+		"}\n"
+		"\n"));
+
+	auto slot(cc_class::make("pool_slot"));
+	slot->vpublic()->add(cc_member::make("pool_slot*", "next"));
+	private_->add(slot);
+
+	auto blocks(cc_class::make("pool_blocks"));
+	auto ctor(blocks->vpublic()->add(blocks->make_constructor()));
+	ctor->add(cc_base_class::make("head_")->make_initializer("nullptr"));
+	ctor->define(cc_block::make());
+	auto dtor(blocks->vpublic()->add(blocks->make_destructor()));
+	dtor->define(cc_block::make())->src()
+		<< "while (head_ != nullptr) {\n"
+		<< "\tauto next(head_->next);\n"
+		<< "\t::operator delete(head_);\n"
+		<< "\thead_ = next;\n"
+		<< "}\n";
+	auto add(blocks->vpublic()->add(cc_method::make("void", "add")));
+	add->add_arg("pool_slot*", "block");
+	add->define(cc_block::make())->src()
+		<< "std::lock_guard<std::mutex> lock(mutex_);\n"
+		<< "block->next = head_;\n"
+		<< "head_ = block;\n";
+	blocks->vprivate()->add(cc_member::make("std::mutex", "mutex_"));
+	blocks->vprivate()->add(cc_member::make("pool_slot*", "head_"));
+	private_->add(blocks);
+
+	auto free(private_->add(cc_method::make("pool_slot*&", "pool_free")));
+	free->make_static();
+	free->define(cc_block::make())->src()
+		<< "thread_local pool_slot* free(nullptr);\n"
+		<< "return free;\n";
+
+	// the first slot of a block links the blocks for their release at exit
+	auto grow(private_->add(cc_method::make("pool_slot*", "pool_grow")));
+	grow->make_static();
+	grow->define(cc_block::make())->src()
+		<< "static_assert(alignof(" << name_ << ") <= alignof(std::max_align_t), \""
+		<< name_ << " is over-aligned for its pool\");\n"
+		<< "static pool_blocks blocks;\n"
+		<< "std::size_t const align(alignof(" << name_ << ") > alignof(pool_slot) ? alignof("
+		<< name_ << ") : alignof(pool_slot));\n"
+		<< "std::size_t const size(sizeof(" << name_ << ") > sizeof(pool_slot) ? sizeof("
+		<< name_ << ") : sizeof(pool_slot));\n"
+		<< "std::size_t const stride((size + align - 1) / align * align);\n"
+		<< "auto block(static_cast<char*>(::operator new(stride * " << objects + 1 << ")));\n"
+		<< "blocks.add(reinterpret_cast<pool_slot*>(block));\n"
+		<< "pool_slot* head(nullptr);\n"
+		<< "for (std::size_t i(" << objects << "); i > 0; --i) {\n"
+		<< "\tauto slot(reinterpret_cast<pool_slot*>(block + i * stride));\n"
+		<< "\tslot->next = head;\n"
+		<< "\thead = slot;\n"
+		<< "}\n"
+		<< "return head;\n";
+}
+
 std::string cc_class::name() const
 {
 	return name_;
 }
 
+// fundamental types and pointers move without throwing anyway
+std::vector<std::string> cc_class::moved_types() const
+{
+	std::vector<std::string> res;
+	for (auto const& base: base_classes_) {
+		res.push_back(base->name());
+	}
+	for (auto const& data: data_members()) {
+		auto type(data.first->type());
+		if (!data.first->fundamental() && type.back() != '*' &&
+		    std::find(res.begin(), res.end(), type) == res.end()) {
+			res.push_back(type);
+		}
+	}
+	return res;
+}
+
+std::vector<std::pair<cc_member::ptr_t, bool>> cc_class::data_members() const
+{
+	std::vector<std::pair<cc_member::ptr_t, bool>> res;
+	bool known(base_classes_.empty());
+	std::size_t offset(has_vptr() ? sizeof(void *) : 0);
+	for (auto const& member: members()) {
+		if (member->is_static()) {
+			continue;
+		}
+		bool follows(false);
+		std::size_t size(member->size());
+		known = known && size != 0;
+		if (known) {
+			auto align(member->alignment());
+			auto start((offset + align - 1) / align * align);
+			follows = !res.empty() && start == offset;
+			offset = start + size;
+		}
+		res.push_back(std::make_pair(member, follows));
+	}
+	return res;
+}
+
+void cc_class::serialize(byte_order order)
+{
+	struct field {
+		std::string name;
+		// byte swapped width, 0 if copied as it is
+		std::size_t width;
+		bool fundamental;
+		// copied together with the next field
+		bool joined;
+	};
+
+	std::vector<field> fields;
+	for (auto const& data: data_members()) {
+		auto const& member(data.first);
+		auto type(member->type());
+		if (!type.empty() && (type.back() == '*' || type.back() == '&')) {
+			throw std::invalid_argument("lccc: cannot serialize " + member->name() + " of " + name_);
+		}
+		bool fundamental(member->fundamental());
+		if (data.second && fundamental && fields.back().fundamental) {
+			fields.back().joined = true;
+		}
+		auto size(member->size());
+		if (fundamental && size > 8) {
+			throw std::invalid_argument("lccc: no byte order for " + type + " "
+				+ member->name() + " of " + name_);
+		}
+		fields.push_back(field{member->name(), fundamental && size > 1 ? size : 0, fundamental, false});
+	}
+	if (fields.empty()) {
+		throw std::invalid_argument("lccc: no data members to serialize in " + name_);
+	}
+
+	bool swapped(false);
+	bool nested(false);
+	std::string total;
+	for (auto const& f: fields) {
+		swapped = swapped || f.width != 0;
+		nested = nested || !f.fundamental;
+		total += (total.empty() ? "" : " + ") + (f.fundamental ? "sizeof(" + f.name + ")"
+			: "serialized_size_of<decltype(" + f.name + ")>(std::is_enum<decltype(" + f.name + ")>())");
+	}
+
+	auto size(public_->add(cc_method::make("std::size_t", "serialized_size")));
+	size->make_static();
+	size->make_constexpr();
+	size->define(cc_block::make())->src() << "return " << total << ";\n";
+
+	// the helpers know the byte order of enumerations
+	auto field = [](std::ostream & os, std::string const& name, bool store) {
+		if (store) {
+			os << "out = serialize_field(out, " << name << ", std::is_enum<decltype(" << name << ")>());\n";
+		} else {
+			os << "in = deserialize_field(in, " << name << ", std::is_enum<decltype(" << name << ")>());\n";
+		}
+	};
+
+	auto copy = [&](std::ostream & os, bool store) {
+		for (std::size_t i(0); i < fields.size(); ++i) {
+			if (!fields[i].fundamental) {
+				field(os, fields[i].name, store);
+				continue;
+			}
+			std::string bytes("sizeof(" + fields[i].name + ")");
+			auto first(i);
+			while (fields[i].joined && i + 1 < fields.size()) {
+				bytes += " + sizeof(" + fields[++i].name + ")";
+			}
+			if (store) {
+				os << "std::memcpy(out, &" << fields[first].name << ", " << bytes << ");\n"
+					<< "out += " << bytes << ";\n";
+			} else {
+				os << "std::memcpy(&" << fields[first].name << ", in, " << bytes << ");\n"
+					<< "in += " << bytes << ";\n";
+			}
+		}
+	};
+
+	auto swap = [&](std::ostream & os, bool store) {
+		for (auto const& f: fields) {
+			if (!f.fundamental) {
+				field(os, f.name, store);
+				continue;
+			}
+			if (f.width == 0) {
+				if (store) {
+					os << "std::memcpy(out, &" << f.name << ", sizeof(" << f.name << "));\n"
+						<< "out += sizeof(" << f.name << ");\n";
+				} else {
+					os << "std::memcpy(&" << f.name << ", in, sizeof(" << f.name << "));\n"
+						<< "in += sizeof(" << f.name << ");\n";
+				}
+				continue;
+			}
+			auto bits(std::to_string(f.width * 8));
+			os << "{\n"
+				<< "\tstd::uint" << bits << "_t bytes;\n"
+				<< "\tstd::memcpy(&bytes, " << (store ? "&" + f.name : "in") << ", " << f.width << ");\n"
+				<< "\tbytes = __builtin_bswap" << bits << "(bytes);\n"
+				<< "\tstd::memcpy(" << (store ? "out" : "&" + f.name) << ", &bytes, " << f.width << ");\n"
+				<< "}\n"
+				<< (store ? "out" : "in") << " += " << f.width << ";\n";
+		}
+	};
+
+	std::string host(order == byte_order::little ? "__ORDER_LITTLE_ENDIAN__" : "__ORDER_BIG_ENDIAN__");
+	for (auto store: {true, false}) {
+		auto method(public_->add(cc_method::make("void", store ? "serialize" : "deserialize")));
+		method->add_arg(store ? "char*" : "char const*", store ? "out" : "in");
+		if (store) {
+			method->make_const();
+		}
+		auto & body(method->define(cc_block::make())->src());
+		if (!swapped) {
+			copy(body, store);
+			continue;
+		}
+		body << "#if __BYTE_ORDER__ == " << host << "\n";
+		copy(body, store);
+		body << "#else\n";
+		swap(body, store);
+		body << "#endif\n";
+	}
+	if (!nested) {
+		return;
+	}
+
+	private_->add(raw::make(
+		"template <typename T>\n"
+		"static constexpr std::size_t serialized_size_of(std::true_type)\n"
+		"{\n"
+		"\treturn sizeof(T);\n"
+		"}\n"
+		"\n"
+		"template <typename T>\n"
+		"static constexpr std::size_t serialized_size_of(std::false_type)\n"
+		"{\n"
+		"\treturn T::serialized_size();\n"
+		"}\n"
+		"\n"
+		"template <typename T>\n"
+		"static char* serialize_field(char* out, T const& value, std::true_type)\n"
+		"{\n"
+		"\tauto bytes(static_cast<typename std::underlying_type<T>::type>(value));\n"
+		"\t#if __BYTE_ORDER__ == " + host + "\n"
+		"\tstd::memcpy(out, &bytes, sizeof(bytes));\n"
+		"\t#else\n"
+		"\tfor (std::size_t i(0); i < sizeof(bytes); ++i) {\n"
+		"\t\tout[i] = reinterpret_cast<char const*>(&bytes)[sizeof(bytes) - 1 - i];\n"
+		"\t}\n"
+		"\t#endif\n"
+		"\treturn out + sizeof(bytes);\n"
+		"}\n"
+		"\n"
+		"template <typename T>\n"
+		"static char* serialize_field(char* out, T const& value, std::false_type)\n"
+		"{\n"
+		"\tvalue.serialize(out);\n"
+		"\treturn out + T::serialized_size();\n"
+		"}\n"
+		"\n"
+		"template <typename T>\n"
+		"static char const* deserialize_field(char const* in, T & value, std::true_type)\n"
+		"{\n"
+		"\ttypename std::underlying_type<T>::type bytes;\n"
+		"\t#if __BYTE_ORDER__ == " + host + "\n"
+		"\tstd::memcpy(&bytes, in, sizeof(bytes));\n"
+		"\t#else\n"
+		"\tfor (std::size_t i(0); i < sizeof(bytes); ++i) {\n"
+		"\t\treinterpret_cast<char*>(&bytes)[i] = in[sizeof(bytes) - 1 - i];\n"
+		"\t}\n"
+		"\t#endif\n"
+		"\tvalue = static_cast<T>(bytes);\n"
+		"\treturn in + sizeof(bytes);\n"
+		"}\n"
+		"\n"
+		"template <typename T>\n"
+		"static char const* deserialize_field(char const* in, T & value, std::false_type)\n"
+		"{\n"
+		"\tvalue.deserialize(in);\n"
+		"\treturn in + T::serialized_size();\n"
+		"}\n"
+		"\n"));
+}
+
+raw::ptr_t cc_class::hashable(std::string const& qualified)
+{
+	auto data(data_members());
+	if (data.empty()) {
+		throw std::invalid_argument("lccc: no data members to hash in " + name_);
+	}
+
+	auto floating = [](cc_member const& member) {
+		return member.type() == "float" || member.type() == "double"
+			|| member.type() == "long double";
+	};
+	auto bytewise = [&](cc_member const& member) {
+		return member.fundamental() && !floating(member);
+	};
+
+	std::string equal;
+	for (std::size_t i(0); i < data.size(); ++i) {
+		auto const& member(*data[i].first);
+		auto name(member.name());
+		equal += equal.empty() ? "return " : "\n\t&& ";
+		if (!bytewise(member) || i + 1 == data.size() || !data[i + 1].second
+			|| !bytewise(*data[i + 1].first)) {
+			equal += name + " == other." + name;
+			continue;
+		}
+		std::string bytes("sizeof(" + name + ")");
+		while (i + 1 < data.size() && data[i + 1].second && bytewise(*data[i + 1].first)) {
+			bytes += " + sizeof(" + data[++i].first->name() + ")";
+		}
+		equal += "std::memcmp(&" + name + ", &other." + name + ", " + bytes + ") == 0";
+	}
+
+	auto eq(public_->add(cc_method::make("bool", "operator==")));
+	eq->add_arg(name_ + " const&", "other");
+	eq->make_const();
+	eq->define(cc_block::make())->src() << equal << ";\n";
+
+	auto ne(public_->add(cc_method::make("bool", "operator!=")));
+	ne->add_arg(name_ + " const&", "other");
+	ne->make_const();
+	ne->define(cc_block::make())->src() << "return !(*this == other);\n";
+
+	auto hash(public_->add(cc_method::make("std::size_t", "hash_value")));
+	hash->make_const();
+	hash->make_noexcept();
+	auto & body(hash->define(cc_block::make())->src());
+	body << "std::uint64_t h(" << data.size() << ");\n";
+	bool other(false);
+	for (auto const& entry: data) {
+		auto const& member(*entry.first);
+		auto name(member.name());
+		if (member.type() == "long double") {
+			// the x87 value has padding bytes, std::hash only looks at the value
+			body << "h = hash_mix(h, std::hash<long double>()(" << name << " == 0 ? 0 : " << name << "));\n";
+		} else if (floating(member)) {
+			auto bits(member.type() == "float" ? "std::uint32_t" : "std::uint64_t");
+			body
+				<< "{\n"
+				<< "\t" << member.type() << " value(" << name << " == 0 ? 0 : " << name << ");\n"
+				<< "\t" << bits << " bits;\n"
+				<< "\tstd::memcpy(&bits, &value, sizeof(bits));\n"
+				<< "\th = hash_mix(h, bits);\n"
+				<< "}\n";
+		} else if (member.fundamental()) {
+			body << "h = hash_mix(h, static_cast<std::uint64_t>(" << name << "));\n";
+		} else {
+			body << "h = hash_mix(h, hash_field(" << name << ", std::is_enum<decltype(" << name << ")>()));\n";
+			other = true;
+		}
+	}
+	body
+		<< "h ^= h >> 33;\n"
+		<< "h *= 0xff51afd7ed558ccdu;\n"
+		<< "h ^= h >> 33;\n"
+		<< "h *= 0xc4ceb9fe1a85ec53u;\n"
+		<< "h ^= h >> 33;\n"
+		<< "return static_cast<std::size_t>(h);\n";
+
+	auto mix(private_->add(cc_method::make("std::uint64_t", "hash_mix")));
+	mix->make_static();
+	mix->make_noexcept();
+	mix->add_arg("std::uint64_t", "h");
+	mix->add_arg("std::uint64_t", "value");
+	mix->define(cc_block::make())->src()
+		<< "h = (h ^ value) * 0x9e3779b97f4a7c15u;\n"
+		<< "return h ^ (h >> 32);\n";
+
+	// std::hash of enumerations is C++14
+	if (other) {
+		private_->add(raw::make(
+			"template <typename T>\n"
+			"static std::uint64_t hash_field(T const& value, std::true_type)\n"
+			"{\n"
+			"\treturn static_cast<std::uint64_t>(static_cast<typename std::underlying_type<T>::type>(value));\n"
+			"}\n"
+			"\n"
+			"template <typename T>\n"
+			"static std::uint64_t hash_field(T const& value, std::false_type)\n"
+			"{\n"
+			"\treturn std::hash<T>()(value);\n"
+			"}\n"
+			"\n"));
+	}
+
+	auto type(qualified.empty() ? name_ : qualified);
+	return raw::make(
+		"namespace std {\n"
+		"\n"
+		"template <>\n"
+		"struct hash<" + type + "> {\n"
+		"\tstd::size_t operator()(" + type + " const& value) const noexcept\n"
+		"\t{\n"
+		"\t\treturn value.hash_value();\n"
+		"\t}\n"
+		"};\n"
+		"\n"
+		"}\n");
+}
+
+raw::ptr_t cc_class::reflect()
+{
+	auto data(data_members());
+	if (data.empty()) {
+		throw std::invalid_argument("lccc: no data members to reflect in " + name_);
+	}
+
+	auto desc(cc_class::make("field_descriptor"));
+	desc->vpublic()->add(cc_member::make("char const*", "name"));
+	desc->vpublic()->add(cc_member::make("std::size_t", "offset"));
+	desc->vpublic()->add(cc_member::make("std::size_t", "size"));
+	desc->vpublic()->add(cc_member::make("char const*", "type"));
+	desc->vpublic()->add(cc_member::make("std::uint32_t", "type_id"));
+	public_->add(desc);
+
+	auto count(public_->add(cc_method::make("std::size_t", "field_count")));
+	count->make_static();
+	count->make_constexpr();
+	count->define(cc_block::make())->src() << "return " << data.size() << ";\n";
+
+	auto field(public_->add(cc_method::make("field_descriptor", "field")));
+	field->make_static();
+	field->make_constexpr();
+	field->add_arg("std::size_t", "index");
+	auto & body(field->define(cc_block::make())->src());
+	for (std::size_t i(0); i < data.size(); ++i) {
+		auto const& member(*data[i].first);
+		std::uint32_t id(2166136261u);
+		for (unsigned char c: member.type()) {
+			id = (id ^ c) * 16777619u;
+		}
+		std::ostringstream hex;
+		hex << std::hex << id;
+		body << (i == 0 ? "return " : "\t: ") << "index == " << i << " ? field_descriptor{\""
+			<< member.name() << "\", offsetof(" << name_ << ", " << member.name() << "), sizeof("
+			<< member.name() << "), \"" << member.type() << "\", 0x" << hex.str() << "u}\n";
+	}
+	body << "\t: throw std::out_of_range(\"" << name_ << "::field\");\n";
+
+	std::string fields("constexpr " + name_ + "::field_descriptor " + name_ + "_fields[] = {\n");
+	for (std::size_t i(0); i < data.size(); ++i) {
+		fields += "\t" + name_ + "::field(" + std::to_string(i) + "),\n";
+	}
+	fields += "};\n";
+	return raw::make(fields);
+}
+
 }
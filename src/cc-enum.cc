@@ -0,0 +1,250 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/lookup.h>
+#include <lccc/snapshot.h>
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+std::string literal(std::int64_t value)
+{
+	if (value == std::numeric_limits<std::int64_t>::min()) {
+		return "(-9223372036854775807 - 1)";
+	}
+	return std::to_string(value);
+}
+
+}
+
+namespace lccc {
+
+cc_enum::enumerator::enumerator(std::string const& name_, std::int64_t value_, bool given_)
+:
+	name(name_),
+	value(value_),
+	given(given_)
+{ }
+
+cc_enum::ptr_t cc_enum::make(std::string const& name, std::string const& type)
+{
+	return ptr_t(new cc_enum(name, type));
+}
+
+cc_enum::cc_enum(std::string const& name, std::string const& type)
+:
+	name_(name),
+	type_(type),
+	scoped_(false),
+	member_(false)
+{ }
+
+void cc_enum::make_scoped()
+{
+	scoped_ = true;
+}
+
+void cc_enum::add(std::string const& name)
+{
+	if (!enumerators_.empty() &&
+	    enumerators_.back().value == std::numeric_limits<std::int64_t>::max()) {
+		throw std::invalid_argument("lccc: value of enumerator " + name + " overflows");
+	}
+	std::int64_t value(enumerators_.empty() ? 0 : enumerators_.back().value + 1);
+	add(enumerator(name, value, false));
+}
+
+void cc_enum::add(std::string const& name, std::int64_t value)
+{
+	add(enumerator(name, value, true));
+}
+
+void cc_enum::add(enumerator const& e)
+{
+	for (auto const& other: enumerators_) {
+		if (other.name == e.name) {
+			throw std::invalid_argument("lccc: duplicate enumerator " + e.name);
+		}
+	}
+	enumerators_.push_back(e);
+	std::lock_guard<std::mutex> lock(mutex_);
+	from_string_.reset();
+}
+
+std::ostream & cc_enum::print(std::ostream & os) const
+{
+	os << "enum " << (scoped_ ? "class " : "") << name_;
+	if (!type_.empty()) {
+		os << " : " << type_;
+	}
+	os << " {\n";
+	for (auto const& e: enumerators_) {
+		os << "\t" << e.name;
+		if (e.given) {
+			os << " = " << literal(e.value);
+		}
+		os << ",\n";
+	}
+	os << "};\n\n";
+
+	auto qualify = [this](cc_method & method) {
+		if (member_) {
+			method.make_static();
+		} else {
+			method.make_inline();
+		}
+	};
+
+	auto to_string(cc_method::make("char const*", "to_string"));
+	qualify(*to_string);
+	to_string->add_arg(name_, "value");
+	auto body(to_string->define(cc_block::make()));
+	print_to_string(body->src());
+	to_string->print(os);
+
+	auto lookup(cc_method::make("bool", "from_string"));
+	qualify(*lookup);
+	lookup->add_arg("char const*", "key");
+	lookup->add_arg("std::size_t", "size");
+	lookup->add_arg(name_ + "&", "value");
+	lookup->define(from_string());
+	return lookup->print(os);
+}
+
+// searching the perfect hash costs more than printing the rest
+cc_block::ptr_t cc_enum::from_string() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!from_string_) {
+		auto lookup(cc_lookup::make(name_, "from_string"));
+		for (auto const& e: enumerators_) {
+			lookup->add(e.name, name_ + "::" + e.name);
+		}
+		from_string_ = lookup->body();
+	}
+	return from_string_;
+}
+
+void cc_enum::print_to_string(std::ostream & os) const
+{
+	if (enumerators_.empty()) {
+		os << "(void)value;\n" << "return \"\";\n";
+		return;
+	}
+
+	// aliases print as the first name given for a value
+	std::vector<enumerator const*> values;
+	for (auto const& e: enumerators_) {
+		values.push_back(&e);
+	}
+	std::stable_sort(values.begin(), values.end(), [](enumerator const* l, enumerator const* r) {
+		return l->value < r->value;
+	});
+	values.erase(std::unique(values.begin(), values.end(), [](enumerator const* l, enumerator const* r) {
+		return l->value == r->value;
+	}), values.end());
+
+	std::int64_t min(values.front()->value);
+	std::uint64_t range(std::uint64_t(values.back()->value) - std::uint64_t(min) + 1);
+	if (range != 0 && range <= 2 * values.size()) {
+		os << "static constexpr char const* names[" << range << "] = {\n";
+		auto it(values.begin());
+		for (std::uint64_t i(0); i < range; ++i) {
+			if (std::uint64_t((*it)->value) - std::uint64_t(min) == i) {
+				os << "\t\"" << (*it++)->name << "\",\n";
+			} else {
+				os << "\t\"\",\n";
+			}
+		}
+		os << "};\n";
+		if (min == 0) {
+			os << "std::uint64_t index(static_cast<std::uint64_t>(value));\n";
+		} else {
+			os << "std::uint64_t index(std::uint64_t(static_cast<std::int64_t>(value)) - "
+				<< "std::uint64_t(" << literal(min) << "));\n";
+		}
+		os << "return index < " << range << " ? names[index] : \"\";\n";
+		return;
+	}
+
+	auto size(values.size());
+	os
+		<< "struct entry {\n"
+		<< "\tstd::int64_t value;\n"
+		<< "\tchar const* name;\n"
+		<< "};\n"
+		<< "static constexpr entry names[" << size << "] = {\n";
+	for (auto e: values) {
+		os << "\t{" << literal(e->value) << ", \"" << e->name << "\"},\n";
+	}
+	os
+		<< "};\n"
+		<< "std::int64_t key(static_cast<std::int64_t>(value));\n"
+		<< "std::size_t first(0);\n"
+		<< "std::size_t count(" << size << ");\n"
+		<< "while (count > 0) {\n"
+		<< "\tstd::size_t half(count / 2);\n"
+		<< "\tif (names[first + half].value < key) {\n"
+		<< "\t\tfirst += half + 1;\n"
+		<< "\t\tcount -= half + 1;\n"
+		<< "\t} else {\n"
+		<< "\t\tcount = half;\n"
+		<< "\t}\n"
+		<< "}\n"
+		<< "return first < " << size << " && names[first].value == key ? names[first].name : \"\";\n";
+}
+
+bool cc_enum::hash(hasher & h) const
+{
+	h.add("cc_enum").add(name_).add(type_).add(scoped_).add(member_);
+	for (auto const& e: enumerators_) {
+		h.add(e.name).add(std::uint64_t(e.value)).add(e.given);
+	}
+	return true;
+}
+
+bool cc_enum::write(snapshot_writer & w) const
+{
+	std::vector<std::string> fields{name_, type_};
+	for (auto const& e: enumerators_) {
+		fields.push_back(e.name);
+		fields.push_back(e.given ? std::to_string(e.value) : "");
+	}
+	w.node(snapshot::kind::cc_enum, (scoped_ ? 1 : 0) | (member_ ? 2 : 0), fields, {});
+	return true;
+}
+
+std::string cc_enum::name() const
+{
+	return name_;
+}
+
+}
@@ -24,6 +24,78 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
+
+#include <algorithm>
+#include <ostream>
+
+namespace {
+
+struct type_layout {
+	char const* type;
+	std::size_t size;
+	// a signed integer
+	bool is_signed;
+};
+
+// LP64 on x86-64, alignment equals size for all of them
+type_layout const known_types[] = {
+	{"bool", 1, false}, {"char", 1, true}, {"signed char", 1, true},
+	{"unsigned char", 1, false},
+	{"int8_t", 1, true}, {"uint8_t", 1, false}, {"std::int8_t", 1, true},
+	{"std::uint8_t", 1, false},
+	{"short", 2, true}, {"unsigned short", 2, false}, {"char16_t", 2, false},
+	{"int16_t", 2, true}, {"uint16_t", 2, false}, {"std::int16_t", 2, true},
+	{"std::uint16_t", 2, false},
+	{"int", 4, true}, {"unsigned", 4, false}, {"unsigned int", 4, false},
+	{"float", 4, false}, {"char32_t", 4, false}, {"wchar_t", 4, true},
+	{"int32_t", 4, true}, {"uint32_t", 4, false}, {"std::int32_t", 4, true},
+	{"std::uint32_t", 4, false},
+	{"long", 8, true}, {"unsigned long", 8, false}, {"long long", 8, true},
+	{"unsigned long long", 8, false},
+	{"double", 8, false}, {"long double", 16, false},
+	{"int64_t", 8, true}, {"uint64_t", 8, false}, {"std::int64_t", 8, true},
+	{"std::uint64_t", 8, false},
+	{"size_t", 8, false}, {"std::size_t", 8, false}, {"ptrdiff_t", 8, true},
+	{"std::ptrdiff_t", 8, true},
+	{"intptr_t", 8, true}, {"uintptr_t", 8, false}, {"std::intptr_t", 8, true},
+	{"std::uintptr_t", 8, false},
+};
+
+std::string unqualified(std::string type)
+{
+	if (type.compare(0, 6, "const ") == 0) {
+		type.erase(0, 6);
+	}
+	if (type.size() > 6 && type.compare(type.size() - 6, 6, " const") == 0) {
+		type.erase(type.size() - 6);
+	}
+	return type;
+}
+
+type_layout const* fundamental_type(std::string const& type)
+{
+	auto plain(unqualified(type));
+	for (auto const& known: known_types) {
+		if (plain == known.type) {
+			return &known;
+		}
+	}
+	return nullptr;
+}
+
+std::size_t known_size(std::string const& type)
+{
+	auto plain(unqualified(type));
+	if (!plain.empty() && (plain.back() == '*' || plain.back() == '&')) {
+		return sizeof(void *);
+	}
+	auto known(fundamental_type(plain));
+	return known ? known->size : 0;
+}
+
+}
 
 namespace lccc {
 
@@ -35,13 +107,124 @@ cc_member::ptr_t cc_member::make(std::string const& type, std::string const& nam
 cc_member::cc_member(std::string const& type, std::string const& name)
 :
 	name_(name),
-	type_(type)
+	type_(type),
+	hot_(false),
+	cold_(false),
+	align_(0),
+	size_(known_size(type)),
+	type_align_(size_),
+	bits_(type == "bool" ? 1 : 0)
 { }
 
 std::ostream & cc_member::print(std::ostream & os) const
 {
-	os << type_ << " " << name_ << ";\n";
+	return format(os, type_, name_, align_);
+}
+
+std::ostream & cc_member::format(std::ostream & os, text_ref type, text_ref name,
+	std::size_t align)
+{
+	if (align != 0) {
+		os << "alignas(" << align << ") ";
+	}
+	os << type << " " << name << ";\n";
 	return os;
 }
 
+bool cc_member::hash(hasher & h) const
+{
+	h.add("cc_member").add(type_).add(name_).add(hot_).add(cold_)
+		.add(std::uint64_t(align_)).add(std::uint64_t(size_)).add(std::uint64_t(type_align_))
+		.add(std::uint64_t(bits_));
+	return true;
+}
+
+bool cc_member::write(snapshot_writer & w) const
+{
+	std::uint8_t flags((hot_ ? 1 : 0) | (cold_ ? 2 : 0));
+	w.node(snapshot::kind::cc_member, flags, {type_, name_,
+		std::to_string(align_), std::to_string(size_), std::to_string(type_align_),
+		std::to_string(bits_)}, {});
+	return true;
+}
+
+void cc_member::make_hot()
+{
+	hot_ = true;
+	cold_ = false;
+}
+
+void cc_member::make_cold()
+{
+	cold_ = true;
+	hot_ = false;
+}
+
+void cc_member::align(std::size_t alignment)
+{
+	align_ = alignment;
+}
+
+void cc_member::layout(std::size_t size, std::size_t alignment)
+{
+	size_ = size;
+	type_align_ = alignment;
+}
+
+void cc_member::pack(std::size_t bits)
+{
+	bits_ = bits;
+}
+
+std::string cc_member::type() const
+{
+	return type_;
+}
+
+std::string cc_member::name() const
+{
+	return name_;
+}
+
+bool cc_member::hot() const
+{
+	return hot_;
+}
+
+bool cc_member::cold() const
+{
+	return cold_;
+}
+
+std::size_t cc_member::size() const
+{
+	return size_;
+}
+
+std::size_t cc_member::alignment() const
+{
+	return std::max(align_, type_align_);
+}
+
+std::size_t cc_member::bits() const
+{
+	return bits_;
+}
+
+bool cc_member::is_static() const
+{
+	return type_.compare(0, 7, "static ") == 0;
+}
+
+bool cc_member::fundamental() const
+{
+	return fundamental_type(type_) != nullptr;
+}
+
+bool cc_member::is_signed() const
+{
+	auto known(fundamental_type(type_));
+	return known && known->is_signed;
+}
+
 }
@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
@@ -45,36 +47,210 @@ cc_method_base::argument::argument(std::string const& type_, std::string const&
 	name(name_)
 { }
 
+cc_method_base::declaration::declaration(text_ref name_, unsigned qualifiers_)
+:
+	name(name_),
+	qualifiers(qualifiers_),
+	condition("")
+{ }
+
 cc_method_base::cc_method_base(std::string const& name)
 :
-	name_(name)
+	name_(name),
+	noexcept_(false),
+	constexpr_(false),
+	inline_(false),
+	default_(false),
+	delete_(false)
 { }
 
-std::string cc_method_base::args() const
+void cc_method_base::make_noexcept(std::string const& condition)
 {
-	std::string sep;
-	std::stringstream res;
+	noexcept_ = true;
+	condition_ = condition;
+}
+
+void cc_method_base::make_constexpr()
+{
+	constexpr_ = true;
+}
+
+void cc_method_base::make_inline()
+{
+	inline_ = true;
+}
+
+void cc_method_base::make_default()
+{
+	default_ = true;
+	delete_ = false;
+}
+
+void cc_method_base::make_delete()
+{
+	delete_ = true;
+	default_ = false;
+}
+
+bool cc_method_base::is_default() const
+{
+	return default_;
+}
+
+bool cc_method_base::is_deleted() const
+{
+	return delete_;
+}
+
+bool cc_method_base::is_noexcept() const
+{
+	return noexcept_;
+}
+
+std::string const& cc_method_base::noexcept_condition() const
+{
+	return condition_;
+}
+
+void cc_method_base::add_attribute(std::string const& attribute)
+{
+	attributes_.push_back(attribute);
+}
+
+std::vector<std::string> const& cc_method_base::attributes() const
+{
+	return attributes_;
+}
+
+bool cc_method_base::hash_base(hasher & h) const
+{
+	h.add(name_).add(std::uint64_t(args_.size()));
+	for (auto arg: args_) {
+		h.add(arg.type).add(arg.name);
+	}
+
+	h.add(noexcept_).add(condition_).add(constexpr_).add(inline_).add(default_).add(delete_)
+		.add(std::uint64_t(attributes_.size()));
+	for (auto const& attribute: attributes_) {
+		h.add(attribute);
+	}
+
+	h.add(bool(src_));
+	return !src_ || h.add(*src_);
+}
+
+unsigned cc_method_base::qualifiers() const
+{
+	return (noexcept_ ? 1 : 0) | (constexpr_ ? 2 : 0) | (inline_ ? 4 : 0) |
+		(default_ ? 8 : 0) | (delete_ ? 16 : 0);
+}
+
+// name, qualifiers, attributes separated by newlines, noexcept
+// condition, arguments
+std::vector<std::string> cc_method_base::base_fields() const
+{
+	std::string attributes;
+	for (auto const& attribute: attributes_) {
+		attributes += (attributes.empty() ? "" : "\n") + attribute;
+	}
+
+	std::vector<std::string> fields{name_, std::to_string(qualifiers()), attributes, condition_};
 	for (auto arg: args_) {
-		res << sep << arg.type;
+		fields.push_back(arg.type);
+		fields.push_back(arg.name);
+	}
+
+	return fields;
+}
+
+std::vector<std::uint32_t> cc_method_base::write_src(snapshot_writer & w) const
+{
+	std::vector<std::uint32_t> children;
+	if (src_) {
+		children.push_back(w.add(*src_));
+	}
+
+	return children;
+}
+
+cc_method_base::declaration cc_method_base::declare() const
+{
+	declaration decl(name_, qualifiers());
+	decl.condition = condition_;
+	decl.attributes.reserve(attributes_.size());
+	for (auto const& attribute: attributes_) {
+		decl.attributes.push_back(attribute);
+	}
+	decl.args.reserve(args_.size() * 2);
+	for (auto const& arg: args_) {
+		decl.args.push_back(arg.type);
+		decl.args.push_back(arg.name);
+	}
+	return decl;
+}
+
+cc_method_base::body_t cc_method_base::body_printer(std::ostream & os) const
+{
+	if (!src_) {
+		return nullptr;
+	}
+	auto block(src_.get());
+	return [block, &os] { block->print(os); };
+}
+
+void cc_method_base::format_attributes(std::ostream & os, declaration const& decl)
+{
+	if (decl.attributes.empty()) {
+		return;
+	}
+
+	std::string sep;
+	os << "[[";
+	for (auto const& attribute: decl.attributes) {
+		os << sep << attribute;
 		sep = ", ";
 	}
+	os << "]] ";
+}
 
-	return res.str();
+void cc_method_base::format_specifiers(std::ostream & os, declaration const& decl)
+{
+	if (decl.qualifiers & 4) {
+		os << "inline ";
+	}
+	if (decl.qualifiers & 2) {
+		os << "constexpr ";
+	}
 }
 
-std::string cc_method_base::named_args() const
+// argument names are left out of declarations
+void cc_method_base::format_args(std::ostream & os, declaration const& decl, bool named)
 {
 	std::string sep;
-	std::stringstream res;
-	for (auto arg: args_) {
-		res << sep << arg.type;
-		if (!arg.name.empty()) {
-			res << " " << arg.name;
+	os << "(";
+	for (std::size_t i(0); i + 1 < decl.args.size(); i += 2) {
+		os << sep << decl.args[i];
+		if (named && !decl.args[i + 1].empty()) {
+			os << " " << decl.args[i + 1];
 		}
 		sep = ", ";
 	}
+	os << ")";
+}
+
+void cc_method_base::format_exceptions(std::ostream & os, declaration const& decl)
+{
+	if (decl.qualifiers & 1) {
+		os << " noexcept";
+		if (!decl.condition.empty()) {
+			os << "(" << decl.condition << ")";
+		}
+	}
+}
 
-	return res.str();
+char const* cc_method_base::special(declaration const& decl)
+{
+	return decl.qualifiers & 8 ? " = default" : decl.qualifiers & 16 ? " = delete" : "";
 }
 
 std::string cc_method_base::name() const
@@ -82,4 +258,14 @@ std::string cc_method_base::name() const
 	return name_;
 }
 
+std::vector<cc_method_base::argument> const& cc_method_base::arguments() const
+{
+	return args_;
+}
+
+cc_block::ptr_t cc_method_base::body() const
+{
+	return src_;
+}
+
 }
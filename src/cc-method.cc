@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
@@ -38,7 +40,9 @@ cc_method::cc_method(std::string const& rtype, std::string const& name)
 	rtype_(rtype),
 	virtual_(false),
 	abstract_(false),
-	const_(false)
+	const_(false),
+	final_(false),
+	static_(false)
 { }
 
 void cc_method::make_virtual()
@@ -57,20 +61,71 @@ void cc_method::make_const()
 	const_ = true;
 }
 
+void cc_method::make_final()
+{
+	final_ = true;
+}
+
+void cc_method::make_static()
+{
+	static_ = true;
+}
+
+void cc_method::make_nonvirtual()
+{
+	virtual_ = false;
+	abstract_ = false;
+	final_ = false;
+}
+
+bool cc_method::is_virtual() const
+{
+	return virtual_;
+}
+
+bool cc_method::is_abstract() const
+{
+	return abstract_;
+}
+
+bool cc_method::is_const() const
+{
+	return const_;
+}
+
+std::string cc_method::rtype() const
+{
+	return rtype_;
+}
+
 std::ostream & cc_method::print(std::ostream & os) const
 {
-	os << (virtual_ ? "virtual " : "");
-	os << rtype_ << " ";
-	os << name_;
-	os << "(" << (src_ ? named_args() : args()) << ")";
-	if (const_) {
+	return format(os, declare(), rtype_, flags(), body_printer(os));
+}
+
+std::ostream & cc_method::format(std::ostream & os, declaration const& decl, text_ref rtype,
+	std::uint8_t flags, body_t const& body)
+{
+	format_attributes(os, decl);
+	os << (flags & 16 ? "static " : "");
+	os << (flags & 1 ? "virtual " : "");
+	format_specifiers(os, decl);
+	os << rtype << " " << decl.name;
+	format_args(os, decl, bool(body));
+	if (flags & 4) {
 		os << " const";
 	}
-	if (abstract_) {
+	format_exceptions(os, decl);
+	if (flags & 8) {
+		os << " final";
+	}
+	if (flags & 2) {
 		os << " = 0;\n";
-	} else if (src_) {
+	} else if (*special(decl)) {
+		os << special(decl) << ";\n";
+	} else if (body) {
 		os << "\n";
-		src_->print(os);
+		body();
 	} else {
 		os << ";\n";
 	}
@@ -78,4 +133,27 @@ std::ostream & cc_method::print(std::ostream & os) const
 	return os;
 }
 
+bool cc_method::hash(hasher & h) const
+{
+	h.add("cc_method").add(rtype_).add(virtual_).add(abstract_).add(const_)
+		.add(final_).add(static_);
+	return hash_base(h);
+}
+
+bool cc_method::write(snapshot_writer & w) const
+{
+	std::vector<std::string> fields{rtype_};
+	for (auto field: base_fields()) {
+		fields.push_back(field);
+	}
+	w.node(snapshot::kind::cc_method, flags(), fields, write_src(w));
+	return true;
+}
+
+std::uint8_t cc_method::flags() const
+{
+	return (virtual_ ? 1 : 0) | (abstract_ ? 2 : 0) | (const_ ? 4 : 0) |
+		(final_ ? 8 : 0) | (static_ ? 16 : 0);
+}
+
 }
@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cc.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
@@ -46,10 +48,28 @@ cc_namespace::add(src::ptr_t const& src)
 
 std::ostream & cc_namespace::print(std::ostream & os) const
 {
-	os << "namespace " << name_ << " {\n";
-	print_content(os);
+	return format(os, name_, [this, &os] { print_content(os); });
+}
+
+std::ostream & cc_namespace::format(std::ostream & os, text_ref name,
+	std::function<void()> const& content)
+{
+	os << "namespace " << name << " {\n";
+	content();
 	os << "}\n";
 	return os;
 }
 
+bool cc_namespace::hash(hasher & h) const
+{
+	h.add("cc_namespace").add(name_);
+	return hash_content(h);
+}
+
+bool cc_namespace::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cc_namespace, 0, {name_}, write_content(w));
+	return true;
+}
+
 }
@@ -23,17 +23,46 @@
    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#include <lccc/base.h>
+#include <lccc/cache.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
 std::ostream & container::print_content(std::ostream & os) const
 {
+	auto cache(render_cache::get(os));
 	for (auto src: content_) {
-		src->print(os);
+		if (cache) {
+			cache->print(*src, os);
+		} else {
+			src->print(os);
+		}
 	}
 
 	return os;
 }
 
+std::vector<std::uint32_t> container::write_content(snapshot_writer & w) const
+{
+	std::vector<std::uint32_t> children;
+	for (auto src: content_) {
+		children.push_back(w.add(*src));
+	}
+
+	return children;
+}
+
+bool container::hash_content(hasher & h) const
+{
+	h.add(std::uint64_t(content_.size()));
+	for (auto src: content_) {
+		if (!h.add(*src)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 }
@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cpp.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 #include <ostream>
 
@@ -36,14 +38,46 @@ cpp_condition::add(src::ptr_t const& src)
 	return src;
 }
 
+src::ptr_t
+cpp_condition::insert(std::size_t pos, src::ptr_t const& src)
+{
+	content_.insert(content_.begin() + pos, src);
+	return src;
+}
+
+src::ptr_t
+cpp_condition::replace(std::size_t pos, src::ptr_t const& src)
+{
+	content_.at(pos) = src;
+	return src;
+}
+
 std::ostream & cpp_condition::print(std::ostream & os) const
 {
-	os << symbol_ << " " << cond_ << "\n";
-	print_content(os);
+	return format(os, symbol_, cond_, [this, &os] { print_content(os); });
+}
+
+std::ostream & cpp_condition::format(std::ostream & os, text_ref symbol, text_ref cond,
+	std::function<void()> const& content)
+{
+	os << symbol << " " << cond << "\n";
+	content();
 	os << "#endif\n";
 	return os;
 }
 
+bool cpp_condition::hash(hasher & h) const
+{
+	h.add("cpp_condition").add(symbol_).add(cond_);
+	return hash_content(h);
+}
+
+bool cpp_condition::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cpp_condition, 0, {symbol_, cond_}, write_content(w));
+	return true;
+}
+
 cpp_condition::cpp_condition(std::string const& symbol, std::string const& cond)
 :
 	symbol_(symbol),
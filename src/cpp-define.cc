@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cpp.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 #include <ostream>
 
@@ -41,7 +43,24 @@ cpp_define::ptr_t cpp_define::make(std::string const& symbol)
 
 std::ostream & cpp_define::print(std::ostream & os) const
 {
-	return os << "#define " << symbol_ << "\n";
+	return format(os, symbol_);
+}
+
+std::ostream & cpp_define::format(std::ostream & os, text_ref symbol)
+{
+	return os << "#define " << symbol << "\n";
+}
+
+bool cpp_define::hash(hasher & h) const
+{
+	h.add("cpp_define").add(symbol_);
+	return true;
+}
+
+bool cpp_define::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cpp_define, 0, {symbol_}, {});
+	return true;
 }
 
 }
@@ -24,6 +24,8 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cpp.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 namespace lccc {
 
@@ -46,9 +48,33 @@ cpp_guard::add(src::ptr_t const& src)
 	return src;
 }
 
+src::ptr_t
+cpp_guard::insert(std::size_t pos, src::ptr_t const& src)
+{
+	return ifndef_->insert(pos + 1, src);
+}
+
+src::ptr_t
+cpp_guard::replace(std::size_t pos, src::ptr_t const& src)
+{
+	return ifndef_->replace(pos + 1, src);
+}
+
 std::ostream & cpp_guard::print(std::ostream & os) const
 {
 	return ifndef_->print(os);
 }
 
+bool cpp_guard::hash(hasher & h) const
+{
+	h.add("cpp_guard");
+	return h.add(*ifndef_);
+}
+
+bool cpp_guard::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cpp_guard, 0, {}, {w.add(*ifndef_)});
+	return true;
+}
+
 }
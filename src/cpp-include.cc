@@ -24,24 +24,62 @@
    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <lccc/cpp.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
 
 #include <ostream>
 
 namespace lccc {
 
-cpp_include::cpp_include(std::string const& name)
+cpp_include::cpp_include(std::string const& name, bool local)
 :
-	name_(name)
+	name_(name),
+	local_(local)
 { }
 
 cpp_include::ptr_t cpp_include::make(std::string const& name)
 {
-	return ptr_t(new cpp_include(name));
+	return ptr_t(new cpp_include(name, false));
+}
+
+cpp_include::ptr_t cpp_include::make_local(std::string const& name)
+{
+	return ptr_t(new cpp_include(name, true));
 }
 
 std::ostream & cpp_include::print(std::ostream & os) const
 {
-	return os << "#include<" << name_ << ">\n";
+	return format(os, name_, local_);
+}
+
+std::ostream & cpp_include::format(std::ostream & os, text_ref name, bool local)
+{
+	if (local) {
+		return os << "#include \"" << name << "\"\n";
+	}
+	return os << "#include<" << name << ">\n";
+}
+
+bool cpp_include::hash(hasher & h) const
+{
+	h.add("cpp_include").add(name_).add(local_);
+	return true;
+}
+
+bool cpp_include::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::cpp_include, local_ ? 1 : 0, {name_}, {});
+	return true;
+}
+
+std::string cpp_include::name() const
+{
+	return name_;
+}
+
+bool cpp_include::local() const
+{
+	return local_;
 }
 
 }
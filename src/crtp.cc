@@ -0,0 +1,185 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/crtp.h>
+
+#include <stdexcept>
+
+namespace {
+
+std::string argument_name(lccc::cc_method::argument const& arg, std::size_t index)
+{
+	return arg.name.empty() ? "arg" + std::to_string(index) : arg.name;
+}
+
+// references and pointers are passed on as they are, anything else is
+// forwarded so by-value and rvalue reference arguments are moved
+std::string forward(lccc::cc_method::argument const& arg, std::size_t index)
+{
+	auto const& type(arg.type);
+	auto name(argument_name(arg, index));
+	bool lvalue(!type.empty() && type.back() == '&' && (type.size() < 2 || type[type.size() - 2] != '&'));
+	if (lvalue || (!type.empty() && type.back() == '*')) {
+		return name;
+	}
+	return "std::forward<" + type + ">(" + name + ")";
+}
+
+// declares the method again with named arguments and a body calling
+// callee.name() with the arguments
+lccc::cc_method::ptr_t forwarder(lccc::cc_method const& method, std::string const& callee)
+{
+	auto res(lccc::cc_method::make(method.rtype(), method.name()));
+	if (method.is_const()) {
+		res->make_const();
+	}
+	if (method.is_noexcept()) {
+		res->make_noexcept(method.noexcept_condition());
+	}
+	for (auto const& attribute: method.attributes()) {
+		res->add_attribute(attribute);
+	}
+	auto const& args(method.arguments());
+	std::string call(callee + method.name() + "(");
+	std::string sep;
+	for (std::size_t i(0); i < args.size(); ++i) {
+		res->add_arg(args[i].type, argument_name(args[i], i));
+		call += sep + forward(args[i], i);
+		sep = ", ";
+	}
+	res->define(lccc::cc_block::make())->src() << "return " << call << ");\n";
+	return res;
+}
+
+}
+
+namespace lccc {
+
+cc_crtp::ptr_t cc_crtp::make(cc_class::ptr_t const& interface)
+{
+	return ptr_t(new cc_crtp(interface));
+}
+
+cc_crtp::cc_crtp(cc_class::ptr_t const& interface)
+:
+	interface_(interface)
+{ }
+
+std::vector<cc_method::ptr_t> cc_crtp::abstract() const
+{
+	std::vector<cc_method::ptr_t> res;
+	for (auto const& method: interface_->vpublic()->methods()) {
+		if (method->is_abstract()) {
+			res.push_back(method);
+		}
+	}
+	if (res.empty()) {
+		throw std::invalid_argument("lccc: no public abstract methods in " + interface_->name());
+	}
+	return res;
+}
+
+cc_class::ptr_t cc_crtp::base() const
+{
+	auto methods(abstract());
+	auto base(cc_class::make(interface_->name() + "_crtp"));
+	base->add_template_parameter("typename Derived");
+	for (auto const& method: methods) {
+		auto self(method->is_const()
+			? "static_cast<Derived const*>(this)->"
+			: "static_cast<Derived*>(this)->");
+		base->vpublic()->add(forwarder(*method, self));
+	}
+
+	// not deleted through the base, so no virtual destructor needed
+	auto dtor(base->make_destructor());
+	dtor->make_default();
+	base->vprotected()->add(dtor);
+	return base;
+}
+
+cc_class::ptr_t cc_crtp::adapter() const
+{
+	auto methods(abstract());
+	auto name(interface_->name() + "_adapter");
+	auto adapter(cc_class::make(name));
+	adapter->add_template_parameter("typename Impl");
+	adapter->make_final();
+	adapter->add(cc_base_class::make(interface_->name()));
+	auto pub(adapter->vpublic());
+
+	auto ctor(adapter->make_constructor());
+	ctor->add_arg("Impl", "impl");
+	ctor->add(cc_base_class::make("impl_")->make_initializer("std::move(impl)"));
+	ctor->define(cc_block::make());
+	pub->add(ctor);
+
+	for (auto const& method: methods) {
+		auto impl(pub->add(forwarder(*method, "impl_.")));
+		impl->make_virtual();
+		impl->make_final();
+	}
+
+	auto get(pub->add(cc_method::make("Impl&", "get")));
+	get->define(cc_block::make())->src() << "return impl_;\n";
+	auto get_const(pub->add(cc_method::make("Impl const&", "get")));
+	get_const->make_const();
+	get_const->define(cc_block::make())->src() << "return impl_;\n";
+
+	adapter->vprivate()->add(cc_member::make("Impl", "impl_"));
+	return adapter;
+}
+
+void cc_crtp::derive(cc_class::ptr_t const& cls) const
+{
+	auto methods(abstract());
+	auto impls(cls->methods());
+	for (auto const& method: methods) {
+		bool found(false);
+		for (auto const& impl: impls) {
+			if (impl->name() == method->name()) {
+				found = true;
+			}
+		}
+		if (!found) {
+			throw std::invalid_argument("lccc: " + cls->name() + " does not implement " + method->name());
+		}
+	}
+
+	auto base(cc_base_class::make(interface_->name() + "_crtp<" + cls->name() + ">"));
+	if (!cls->replace(interface_->name(), base)) {
+		throw std::invalid_argument("lccc: " + cls->name() + " is not derived from " + interface_->name());
+	}
+
+	for (auto const& impl: impls) {
+		for (auto const& method: methods) {
+			if (impl->name() == method->name()) {
+				impl->make_nonvirtual();
+			}
+		}
+	}
+}
+
+}
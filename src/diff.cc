@@ -0,0 +1,358 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/diff.h>
+#include <lccc/hash.h>
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace lccc {
+
+namespace {
+
+// The subtree hashes of one tree, large subtrees are hashed once.
+class tree {
+public:
+	// invalid if the subtree holds a lazy node
+	hasher::digest hash(src const& node)
+	{
+		hasher h(&memo_);
+		hasher::digest res;
+		res.valid = h.add(node);
+		res.value = h.value();
+		res.check = h.check();
+		return res;
+	}
+
+private:
+	hasher::memo_t memo_;
+};
+
+// One node as it would be written to a snapshot, its children are
+// collected without being written themselves.
+class shape : public snapshot_writer {
+public:
+	explicit shape(src const& node)
+	:
+		type_(snapshot::kind::raw),
+		flags_(0),
+		valid_(false)
+	{
+		valid_ = node.write(*this);
+	}
+
+	std::uint32_t add(src const& node) override
+	{
+		added_.push_back(&node);
+		return added_.size() - 1;
+	}
+
+	void node(snapshot::kind type, std::uint8_t flags,
+		std::vector<std::string> const& fields,
+		std::vector<std::uint32_t> const& children) override
+	{
+		type_ = type;
+		flags_ = flags;
+		fields_ = fields;
+		for (auto i: children) {
+			children_.push_back(added_[i]);
+		}
+	}
+
+	// false for lazy nodes, they have no structure before they are printed
+	bool valid() const
+	{
+		return valid_;
+	}
+
+	snapshot::kind type() const
+	{
+		return type_;
+	}
+
+	std::uint8_t flags() const
+	{
+		return flags_;
+	}
+
+	std::vector<std::string> const& fields() const
+	{
+		return fields_;
+	}
+
+	std::vector<src const*> const& children() const
+	{
+		return children_;
+	}
+
+private:
+	snapshot::kind type_;
+	std::uint8_t flags_;
+	std::vector<std::string> fields_;
+	std::vector<src const*> added_;
+	std::vector<src const*> children_;
+	bool valid_;
+};
+
+bool descend(snapshot::kind kind)
+{
+	switch (kind) {
+	case snapshot::kind::cc_namespace:
+	case snapshot::kind::cc_class:
+	case snapshot::kind::cc_visibility:
+	case snapshot::kind::cpp_condition:
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::string name(shape const& n)
+{
+	auto const& fields(n.fields());
+	switch (n.type()) {
+	case snapshot::kind::cc_method:
+	case snapshot::kind::cc_member:
+	case snapshot::kind::cc_array:
+		return fields[1];
+	case snapshot::kind::cpp_condition:
+		return fields[0] + " " + fields[1];
+	case snapshot::kind::cc_block:
+	case snapshot::kind::cpp_guard:
+	case snapshot::kind::raw:
+		return "";
+	default:
+		return fields.empty() ? "" : fields[0];
+	}
+}
+
+// identifies a node among its siblings, overloads differ by arguments
+std::string key(shape const& n)
+{
+	std::string res(std::to_string(int(n.type())) + ":" + name(n));
+	std::size_t first(0);
+	switch (n.type()) {
+	case snapshot::kind::cc_method: first = 4; break;
+	case snapshot::kind::cc_constructor: first = 3; break;
+	default: return res;
+	}
+
+	auto const& fields(n.fields());
+	for (auto i(first); i < fields.size(); i += 2) {
+		res += "," + fields[i];
+	}
+	return res;
+}
+
+class differ {
+public:
+	differ(tree & old_tree, tree & new_tree, std::vector<change> & changes)
+	:
+		old_(old_tree),
+		new_(new_tree),
+		changes_(changes)
+	{ }
+
+	void compare(src const& o, shape const& so, src const& n, shape const& sn,
+		std::vector<std::string> path)
+	{
+		auto ho(old_.hash(o));
+		auto hn(new_.hash(n));
+		if (ho.valid && hn.valid && ho.value == hn.value && ho.check == hn.check) {
+			return;
+		}
+
+		// the content of a header lives in the condition of its guard
+		if (sn.type() == snapshot::kind::header) {
+			if (!same_node(so, sn) || !compare_children(content(so), content(sn), path)) {
+				report(change::type::modified, sn.type(), path, &o, &n);
+			}
+			return;
+		}
+
+		path.push_back(name(sn));
+		if (!descend(sn.type()) || !same_node(so, sn) || !compare_children(so, sn, path)) {
+			report(change::type::modified, sn.type(), path, &o, &n);
+		}
+	}
+
+private:
+	static shape content(shape const& n)
+	{
+		return shape(*shape(*n.children()[0]).children()[0]);
+	}
+
+	static bool same_node(shape const& o, shape const& n)
+	{
+		return o.flags() == n.flags() && o.fields() == n.fields();
+	}
+
+	// returns false if the children were reordered or one of them is lazy
+	bool compare_children(shape const& o, shape const& n,
+		std::vector<std::string> const& path)
+	{
+		std::vector<shape> old_children;
+		for (auto child: o.children()) {
+			old_children.emplace_back(*child);
+			if (!old_children.back().valid()) {
+				return false;
+			}
+		}
+		std::vector<shape> new_children;
+		for (auto child: n.children()) {
+			new_children.emplace_back(*child);
+			if (!new_children.back().valid()) {
+				return false;
+			}
+		}
+
+		std::unordered_map<std::string, std::vector<std::size_t>> old_keys;
+		for (std::size_t i(old_children.size()); i-- > 0;) {
+			old_keys[key(old_children[i])].push_back(i);
+		}
+
+		std::vector<std::pair<std::size_t, std::size_t>> matched;
+		std::vector<bool> old_matched(old_children.size(), false);
+		std::vector<std::size_t> added;
+		for (std::size_t i(0); i < new_children.size(); ++i) {
+			auto it(old_keys.find(key(new_children[i])));
+			if (it == old_keys.end() || it->second.empty()) {
+				added.push_back(i);
+				continue;
+			}
+			matched.emplace_back(it->second.back(), i);
+			old_matched[it->second.back()] = true;
+			it->second.pop_back();
+		}
+
+		for (std::size_t i(1); i < matched.size(); ++i) {
+			if (matched[i].first < matched[i - 1].first) {
+				return false;
+			}
+		}
+
+		auto first(changes_.size());
+		for (std::size_t i(0); i < old_children.size(); ++i) {
+			if (!old_matched[i]) {
+				auto const& child(old_children[i]);
+				report(change::type::removed, child.type(), with(path, child),
+					o.children()[i], nullptr);
+			}
+		}
+		for (auto i: added) {
+			auto const& child(new_children[i]);
+			report(change::type::added, child.type(), with(path, child),
+				nullptr, n.children()[i]);
+		}
+		for (auto const& m: matched) {
+			compare(*o.children()[m.first], old_children[m.first],
+				*n.children()[m.second], new_children[m.second], path);
+		}
+
+		// only the order of additions and removals changed
+		return changes_.size() != first;
+	}
+
+	static std::vector<std::string> with(std::vector<std::string> path, shape const& n)
+	{
+		path.push_back(name(n));
+		return path;
+	}
+
+	void report(change::type what, snapshot::kind kind, std::vector<std::string> const& path,
+		src const* old_node, src const* new_node)
+	{
+		changes_.emplace_back(what, kind, path, old_node, new_node);
+	}
+
+	tree & old_;
+	tree & new_;
+	std::vector<change> & changes_;
+};
+
+}
+
+change::change(type what_, snapshot::kind kind_, std::vector<std::string> const& path_,
+	src const* old_node_, src const* new_node_)
+:
+	what(what_),
+	kind(kind_),
+	path(path_),
+	old_node(old_node_),
+	new_node(new_node_)
+{ }
+
+std::vector<change> diff(src const& old_root, src const& new_root)
+{
+	shape o(old_root);
+	shape n(new_root);
+	if (!o.valid() || !n.valid()) {
+		throw std::invalid_argument("lccc: a lazy node can not be the root of a diff");
+	}
+
+	std::vector<change> changes;
+	if (key(o) != key(n)) {
+		changes.emplace_back(change::type::modified, n.type(),
+			std::vector<std::string>{name(n)}, &old_root, &new_root);
+		return changes;
+	}
+
+	tree old_tree;
+	tree new_tree;
+	differ(old_tree, new_tree, changes).compare(old_root, o, new_root, n, {});
+	return changes;
+}
+
+std::vector<change> diff(file_map const& old_files, file_map const& new_files)
+{
+	std::vector<change> changes;
+	for (auto const& file: old_files) {
+		if (!new_files.count(file.first)) {
+			changes.emplace_back(change::type::removed, snapshot::kind::header,
+				std::vector<std::string>{file.first}, file.second.get(), nullptr);
+		}
+	}
+
+	for (auto const& file: new_files) {
+		auto it(old_files.find(file.first));
+		if (it == old_files.end()) {
+			changes.emplace_back(change::type::added, snapshot::kind::header,
+				std::vector<std::string>{file.first}, nullptr, file.second.get());
+			continue;
+		}
+
+		hasher o;
+		hasher n;
+		if (!o.add(*it->second) || !n.add(*file.second) || o.value() != n.value()) {
+			changes.emplace_back(change::type::modified, snapshot::kind::header,
+				std::vector<std::string>{file.first}, it->second.get(), file.second.get());
+		}
+	}
+
+	return changes;
+}
+
+}
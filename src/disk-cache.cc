@@ -0,0 +1,211 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/cache.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace {
+
+bool parse_key(std::string const& name, std::uint64_t & key)
+{
+	if (name.size() != 16) {
+		return false;
+	}
+
+	key = 0;
+	for (auto c: name) {
+		key <<= 4;
+		if (c >= '0' && c <= '9') {
+			key |= c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			key |= c - 'a' + 10;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+namespace lccc {
+
+disk_cache::entry::entry(std::uint64_t key_, std::size_t size_)
+:
+	key(key_),
+	size(size_)
+{ }
+
+disk_cache::ptr_t disk_cache::make(std::string const& dir, std::size_t max_size, std::size_t min_size)
+{
+	return ptr_t(new disk_cache(dir, max_size, min_size));
+}
+
+disk_cache::disk_cache(std::string const& dir, std::size_t max_size, std::size_t min_size)
+:
+	dir_(dir),
+	max_size_(max_size),
+	min_size_(min_size),
+	size_(0)
+{
+	if (::mkdir(dir_.c_str(), 0777) != 0 && errno != EEXIST) {
+		throw std::system_error(errno, std::system_category(), dir_);
+	}
+	scan();
+	evict();
+}
+
+std::string disk_cache::path(std::uint64_t key) const
+{
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+	return dir_ + "/" + name;
+}
+
+void disk_cache::scan()
+{
+	struct found {
+		std::uint64_t key;
+		std::size_t size;
+		std::time_t used;
+	};
+
+	std::vector<found> files;
+	auto dir(::opendir(dir_.c_str()));
+	if (!dir) {
+		throw std::system_error(errno, std::system_category(), dir_);
+	}
+	while (auto ent = ::readdir(dir)) {
+		std::uint64_t key;
+		struct stat st;
+		if (parse_key(ent->d_name, key) && ::stat(path(key).c_str(), &st) == 0) {
+			files.push_back(found{key, std::size_t(st.st_size), st.st_mtime});
+		}
+	}
+	::closedir(dir);
+
+	std::stable_sort(files.begin(), files.end(),
+		[](found const& a, found const& b) { return a.used < b.used; });
+	for (auto const& f: files) {
+		index_[f.key] = lru_.insert(lru_.end(), entry(f.key, f.size));
+		size_ += f.size;
+	}
+}
+
+void disk_cache::evict()
+{
+	while (size_ > max_size_ && !lru_.empty()) {
+		auto const& victim(lru_.front());
+		std::remove(path(victim.key).c_str());
+		size_ -= victim.size;
+		index_.erase(victim.key);
+		lru_.pop_front();
+	}
+}
+
+bool disk_cache::load(std::uint64_t key, std::string & fragment)
+{
+	auto it(index_.find(key));
+	if (it == index_.end()) {
+		return false;
+	}
+
+	std::ifstream in(path(key), std::ios::binary);
+	if (!in) {
+		size_ -= it->second->size;
+		lru_.erase(it->second);
+		index_.erase(it);
+		return false;
+	}
+
+	std::stringstream buf;
+	buf << in.rdbuf();
+	fragment = buf.str();
+	lru_.splice(lru_.end(), lru_, it->second);
+	::utime(path(key).c_str(), nullptr);
+	return true;
+}
+
+void disk_cache::store(std::uint64_t key, std::string const& fragment)
+{
+	if (index_.count(key) || fragment.size() > max_size_ || fragment.size() < min_size_) {
+		return;
+	}
+
+	// unique per writer, generator runs may share the directory
+	auto name(path(key));
+	auto tmp(name + ".XXXXXX");
+	int fd(::mkstemp(&tmp[0]));
+	if (fd < 0) {
+		return;
+	}
+	::close(fd);
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		if (!(out << fragment) || !out.flush()) {
+			std::remove(tmp.c_str());
+			return;
+		}
+	}
+	if (std::rename(tmp.c_str(), name.c_str()) != 0) {
+		std::remove(tmp.c_str());
+		return;
+	}
+
+	index_[key] = lru_.insert(lru_.end(), entry(key, fragment.size()));
+	size_ += fragment.size();
+	evict();
+}
+
+std::size_t disk_cache::size() const
+{
+	return size_;
+}
+
+std::size_t disk_cache::max_size() const
+{
+	return max_size_;
+}
+
+std::size_t disk_cache::min_size() const
+{
+	return min_size_;
+}
+
+}
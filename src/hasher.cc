@@ -0,0 +1,126 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/hash.h>
+
+namespace lccc {
+
+hasher::hasher()
+:
+	state_(0xcbf29ce484222325ULL),
+	check_(0x84222325cbf29ce4ULL),
+	bytes_(0),
+	memo_(nullptr)
+{ }
+
+hasher::hasher(memo_t * memo)
+:
+	state_(0xcbf29ce484222325ULL),
+	check_(0x84222325cbf29ce4ULL),
+	bytes_(0),
+	memo_(memo)
+{ }
+
+void hasher::update(void const* data, std::size_t size)
+{
+	auto bytes(static_cast<unsigned char const*>(data));
+	bytes_ += size;
+	for (std::size_t i(0); i < size; ++i) {
+		state_ ^= bytes[i];
+		state_ *= 0x100000001b3ULL;
+		check_ ^= bytes[i];
+		check_ *= 0x9e3779b97f4a7c15ULL;
+	}
+}
+
+hasher & hasher::add(char const* str)
+{
+	return add(std::string(str));
+}
+
+hasher & hasher::add(std::string const& str)
+{
+	return add(str.data(), str.size());
+}
+
+hasher & hasher::add(char const* data, std::size_t size)
+{
+	add(std::uint64_t(size));
+	update(data, size);
+	return *this;
+}
+
+hasher & hasher::add(std::uint64_t val)
+{
+	unsigned char bytes[8];
+	for (auto & b: bytes) {
+		b = val & 0xff;
+		val >>= 8;
+	}
+	update(bytes, sizeof(bytes));
+	return *this;
+}
+
+hasher & hasher::add(bool val)
+{
+	unsigned char byte(val ? 1 : 0);
+	update(&byte, 1);
+	return *this;
+}
+
+bool hasher::add(src const& node)
+{
+	auto found(memo_ ? memo_->find(&node) : memo_t::iterator());
+	digest res;
+	if (memo_ && found != memo_->end()) {
+		res = found->second;
+	} else {
+		hasher sub(memo_);
+		res.valid = node.hash(sub);
+		res.value = sub.state_;
+		res.check = sub.check_;
+		bytes_ += sub.bytes_;
+		if (memo_ && sub.bytes_ >= 512) {
+			memo_->emplace(&node, res);
+		}
+	}
+
+	if (res.valid) {
+		add(res.value).add(res.check);
+	}
+	return res.valid;
+}
+
+std::uint64_t hasher::value() const
+{
+	return state_;
+}
+
+std::uint64_t hasher::check() const
+{
+	return check_;
+}
+
+}
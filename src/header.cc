@@ -25,6 +25,10 @@
  */
 
 #include <lccc/header.h>
+#include <lccc/hash.h>
+#include <lccc/snapshot.h>
+
+#include <algorithm>
 
 namespace {
 
@@ -51,7 +55,43 @@ header::ptr_t header::make(std::string const& name)
 
 void header::add(src::ptr_t const& src)
 {
-	guard_->add(src);
+	auto include(std::dynamic_pointer_cast<cpp_include>(src));
+	if (!include) {
+		guard_->add(src);
+		return;
+	}
+
+	std::size_t pos(0);
+	for (auto const& known: includes_) {
+		if (known->name() == include->name() && known->local() == include->local()) {
+			return;
+		}
+		if (!before(*include, *known)) {
+			++pos;
+		}
+	}
+	includes_.insert(includes_.begin() + pos, include);
+	guard_->insert(pos, include);
+}
+
+void header::make_deterministic()
+{
+	deterministic_ = true;
+	std::stable_sort(includes_.begin(), includes_.end(),
+		[this](cpp_include::ptr_t const& l, cpp_include::ptr_t const& r) {
+			return before(*l, *r);
+		});
+	for (std::size_t i(0); i < includes_.size(); ++i) {
+		guard_->replace(i, includes_[i]);
+	}
+}
+
+bool header::before(cpp_include const& l, cpp_include const& r) const
+{
+	if (l.local() != r.local()) {
+		return r.local();
+	}
+	return deterministic_ && l.name() < r.name();
 }
 
 std::ostream & header::print(std::ostream & os) const
@@ -59,8 +99,22 @@ std::ostream & header::print(std::ostream & os) const
 	return guard_->print(os);
 }
 
+bool header::hash(hasher & h) const
+{
+	h.add("header").add(deterministic_);
+	return h.add(*guard_);
+}
+
+bool header::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::header, deterministic_ ? 1 : 0, {name_}, {w.add(*guard_)});
+	return true;
+}
+
 header::header(std::string const& name)
 :
+	name_(name),
+	deterministic_(false),
 	guard_(cpp_guard::make(path2guard(name)))
 { }
 
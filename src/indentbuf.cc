@@ -1,4 +1,5 @@
 #include <lccc/indent.h>
+#include <cstring>
 #include <ostream>
 
 namespace lccc {
@@ -36,4 +37,26 @@ int indent::overflow(int ch)
 	return dest_->sputc(ch);
 }
 
+// whole runs up to the next newline are passed on at once
+std::streamsize indent::xsputn(char const* s, std::streamsize n)
+{
+	std::streamsize done(0);
+	while (done < n) {
+		if (line_start_ && s[done] != '\n') {
+			dest_->sputn(indent_.c_str(), indent_.size());
+		}
+
+		auto nl(static_cast<char const*>(std::memchr(s + done, '\n', n - done)));
+		std::streamsize len(nl ? nl - (s + done) + 1 : n - done);
+		auto written(dest_->sputn(s + done, len));
+		done += written;
+		if (written != len) {
+			line_start_ = false;
+			break;
+		}
+		line_start_ = (nl != nullptr);
+	}
+	return done;
+}
+
 }
@@ -0,0 +1,272 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/lookup.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+std::uint32_t const fnv_basis(2166136261u);
+std::uint32_t const fnv_prime(16777619u);
+// the search gives up on a seed after this many displacements per bucket
+std::int32_t const max_displacement(1 << 20);
+
+std::uint32_t key_hash(std::uint32_t seed, std::string const& key)
+{
+	std::uint32_t h(fnv_basis ^ seed);
+	for (auto c: key) {
+		h = (h ^ static_cast<unsigned char>(c)) * fnv_prime;
+	}
+	return h;
+}
+
+std::uint32_t slot_hash(std::uint32_t h, std::int32_t d)
+{
+	std::uint32_t x(h + std::uint32_t(d) * 0x9e3779b9u);
+	x = (x ^ (x >> 16)) * 0x85ebca6bu;
+	x = (x ^ (x >> 13)) * 0xc2b2ae35u;
+	return x ^ (x >> 16);
+}
+
+// Hash and displace: keys are grouped into buckets by their hash, the
+// largest buckets are placed first by searching a displacement that
+// moves all their keys to free slots. Buckets with a single key store
+// the slot itself as a negative displacement.
+bool search(std::vector<std::uint32_t> const& hashes,
+	std::vector<std::int32_t> & displacement, std::vector<std::size_t> & slots)
+{
+	std::size_t size(hashes.size());
+	std::vector<std::vector<std::size_t>> buckets(size);
+	for (std::size_t i(0); i < size; ++i) {
+		buckets[hashes[i] % size].push_back(i);
+	}
+
+	std::vector<std::size_t> order(size);
+	for (std::size_t i(0); i < size; ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t l, std::size_t r) {
+		return buckets[l].size() > buckets[r].size();
+	});
+
+	displacement.assign(size, 0);
+	slots.assign(size, 0);
+	std::vector<bool> used(size, false);
+	std::vector<std::size_t> taken;
+	std::size_t next(0);
+	for (auto b: order) {
+		auto const& bucket(buckets[b]);
+		if (bucket.empty()) {
+			break;
+		}
+
+		if (bucket.size() == 1) {
+			while (used[next]) {
+				++next;
+			}
+			used[next] = true;
+			slots[bucket[0]] = next;
+			displacement[b] = -std::int32_t(next) - 1;
+			continue;
+		}
+
+		std::int32_t d(0);
+		for (; d < max_displacement; ++d) {
+			taken.clear();
+			for (auto key: bucket) {
+				std::size_t slot(slot_hash(hashes[key], d) % size);
+				if (used[slot] || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+					break;
+				}
+				taken.push_back(slot);
+			}
+			if (taken.size() == bucket.size()) {
+				break;
+			}
+		}
+		if (d == max_displacement) {
+			return false;
+		}
+
+		displacement[b] = d;
+		for (std::size_t i(0); i < bucket.size(); ++i) {
+			used[taken[i]] = true;
+			slots[bucket[i]] = taken[i];
+		}
+	}
+
+	return true;
+}
+
+std::string quote(std::string const& key)
+{
+	static char const digits[] = "01234567";
+
+	std::string res("\"");
+	for (auto c: key) {
+		unsigned char u(c);
+		if (u >= 0x20 && u < 0x7f && c != '"' && c != '\\' && c != '?') {
+			res += c;
+		} else {
+			res += '\\';
+			res += digits[u >> 6];
+			res += digits[(u >> 3) & 7];
+			res += digits[u & 7];
+		}
+	}
+	res += '"';
+	return res;
+}
+
+}
+
+namespace lccc {
+
+cc_lookup::entry::entry(std::string const& key_, std::string const& value_)
+:
+	key(key_),
+	value(value_)
+{ }
+
+cc_lookup::ptr_t cc_lookup::make(std::string const& rtype, std::string const& name,
+	std::string const& fallback)
+{
+	return ptr_t(new cc_lookup(rtype, name, fallback));
+}
+
+cc_lookup::cc_lookup(std::string const& rtype, std::string const& name,
+	std::string const& fallback)
+:
+	rtype_(rtype),
+	name_(name),
+	fallback_(fallback)
+{ }
+
+void cc_lookup::add(std::string const& key, std::string const& value)
+{
+	entries_.emplace_back(key, value);
+}
+
+cc_method::ptr_t cc_lookup::generate() const
+{
+	auto method(cc_method::make(fallback_.empty() ? "bool" : rtype_, name_));
+	method->add_arg("char const*", "key");
+	method->add_arg("std::size_t", "size");
+	if (fallback_.empty()) {
+		method->add_arg(rtype_ + "&", "value");
+	}
+	method->define(body());
+	return method;
+}
+
+cc_block::ptr_t cc_lookup::body() const
+{
+	auto body(cc_block::make());
+	std::string hit(fallback_.empty() ? "value = e.value;\n\treturn true;\n" : "return e.value;\n");
+	std::string miss(fallback_.empty() ? "return false;\n" : "return " + fallback_ + ";\n");
+
+	if (entries_.empty()) {
+		body->src()
+			<< "(void)key;\n"
+			<< "(void)size;\n";
+		if (fallback_.empty()) {
+			body->src() << "(void)value;\n";
+		}
+		body->src() << miss;
+		return body;
+	}
+
+	std::unordered_set<std::string> keys;
+	for (auto const& e: entries_) {
+		if (!keys.insert(e.key).second) {
+			throw std::invalid_argument("lccc: duplicate lookup key " + quote(e.key));
+		}
+	}
+
+	std::uint32_t seed(0);
+	std::vector<std::uint32_t> hashes(entries_.size());
+	std::vector<std::int32_t> displacement;
+	std::vector<std::size_t> slots;
+	for (;; ++seed) {
+		for (std::size_t i(0); i < entries_.size(); ++i) {
+			hashes[i] = key_hash(seed, entries_[i].key);
+		}
+		if (search(hashes, displacement, slots)) {
+			break;
+		}
+	}
+
+	std::vector<entry const*> table(entries_.size());
+	for (std::size_t i(0); i < entries_.size(); ++i) {
+		table[slots[i]] = &entries_[i];
+	}
+
+	auto size(std::to_string(entries_.size()));
+	auto & os(body->src());
+	os
+		<< "struct entry {\n"
+		<< "\tchar const* key;\n"
+		<< "\tstd::size_t size;\n"
+		<< "\t" << rtype_ << " value;\n"
+		<< "};\n";
+
+	auto disp(cc_array::make("std::int32_t", "displacement", displacement));
+	disp->make_static();
+	disp->make_constexpr();
+	disp->print(os);
+
+	os << "static constexpr entry table[" << size << "] = {\n";
+	for (auto e: table) {
+		os << "\t{" << quote(e->key) << ", " << e->key.size() << ", " << e->value << "},\n";
+	}
+	os << "};\n"
+		<< "\n"
+		<< "std::uint32_t h(" << (fnv_basis ^ seed) << "u);\n"
+		<< "for (std::size_t i(0); i < size; ++i) {\n"
+		<< "\th = (h ^ static_cast<unsigned char>(key[i])) * " << fnv_prime << "u;\n"
+		<< "}\n"
+		<< "std::int32_t d(displacement[h % " << size << "]);\n"
+		<< "std::uint32_t slot;\n"
+		<< "if (d < 0) {\n"
+		<< "\tslot = std::uint32_t(-(d + 1));\n"
+		<< "} else {\n"
+		<< "\tstd::uint32_t x(h + std::uint32_t(d) * 0x9e3779b9u);\n"
+		<< "\tx = (x ^ (x >> 16)) * 0x85ebca6bu;\n"
+		<< "\tx = (x ^ (x >> 13)) * 0xc2b2ae35u;\n"
+		<< "\tslot = (x ^ (x >> 16)) % " << size << ";\n"
+		<< "}\n"
+		<< "entry const& e(table[slot]);\n"
+		<< "if (e.size == size && std::memcmp(e.key, key, size) == 0) {\n"
+		<< "\t" << hit
+		<< "}\n"
+		<< miss;
+
+	return body;
+}
+
+}
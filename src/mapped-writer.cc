@@ -0,0 +1,244 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/output.h>
+
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <ostream>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+class counter : public std::streambuf {
+public:
+	counter()
+	:
+		count_(0)
+	{
+		setp(area_, area_ + sizeof(area_));
+	}
+
+	std::size_t count() const
+	{
+		return count_ + (pptr() - pbase());
+	}
+
+protected:
+	int overflow(int ch) override
+	{
+		count_ += pptr() - pbase();
+		setp(area_, area_ + sizeof(area_));
+		if (ch != traits_type::eof()) {
+			++count_;
+		}
+		return traits_type::not_eof(ch);
+	}
+
+	std::streamsize xsputn(char const*, std::streamsize n) override
+	{
+		count_ += n;
+		return n;
+	}
+
+private:
+	std::size_t count_;
+	char area_[4096];
+};
+
+}
+
+namespace lccc {
+
+std::size_t mapped_writer::measure(src const& node)
+{
+	counter buf;
+	std::ostream os(&buf);
+	node.print(os);
+	return buf.count();
+}
+
+void mapped_writer::write(std::string const& path, src const& node)
+{
+	mapped_writer out(path, 1 << 20);
+	out.grow_ = true;
+	std::ostream os(&out);
+	node.print(os);
+	out.close();
+}
+
+mapped_writer::mapped_writer(std::string const& path, std::size_t size)
+:
+	fd_(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)),
+	size_(size),
+	map_(nullptr),
+	grow_(false),
+	error_(0)
+{
+	if (fd_ < 0) {
+		throw std::system_error(errno, std::system_category(), path);
+	}
+
+	// reserve the blocks, running out of space in a mapping is SIGBUS
+	if (size_ != 0 && ::ftruncate(fd_, size_) == 0 &&
+	    ::posix_fallocate(fd_, 0, size_) == 0) {
+		void * map(::mmap(nullptr, size_, PROT_WRITE, MAP_SHARED, fd_, 0));
+		if (map != MAP_FAILED) {
+			map_ = static_cast<char *>(map);
+			::madvise(map_, size_, MADV_SEQUENTIAL);
+			setp(map_, map_ + size_);
+			return;
+		}
+	}
+
+	if (size_ != 0) {
+		::ftruncate(fd_, 0);
+	}
+	buffer_.resize(1 << 16);
+	setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+mapped_writer::~mapped_writer()
+{
+	finish();
+}
+
+bool mapped_writer::mapped() const
+{
+	return map_ != nullptr;
+}
+
+bool mapped_writer::flush()
+{
+	if (map_ || error_) {
+		return !error_;
+	}
+
+	std::size_t size(pptr() - pbase());
+	std::size_t done(0);
+	while (done < size) {
+		auto res(::write(fd_, buffer_.data() + done, size - done));
+		if (res < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			error_ = errno;
+			return false;
+		}
+		done += res;
+	}
+	setp(buffer_.data(), buffer_.data() + buffer_.size());
+	return true;
+}
+
+// doubles the file and its mapping, the output stays where it is
+bool mapped_writer::grow()
+{
+	std::size_t used(pptr() - pbase());
+	std::size_t size(size_ * 2);
+	if (::ftruncate(fd_, size) != 0) {
+		error_ = errno;
+		return false;
+	}
+	// posix_fallocate() returns the error instead of setting errno
+	if (int err = ::posix_fallocate(fd_, size_, size - size_)) {
+		error_ = err;
+		return false;
+	}
+	void * map(::mremap(map_, size_, size, MREMAP_MAYMOVE));
+	if (map == MAP_FAILED) {
+		error_ = errno;
+		return false;
+	}
+	map_ = static_cast<char *>(map);
+	size_ = size;
+	::madvise(map_ + used, size_ - used, MADV_SEQUENTIAL);
+	setp(map_, map_ + size_);
+	for (; used > INT_MAX; used -= INT_MAX) {
+		pbump(INT_MAX);
+	}
+	pbump(used);
+	return true;
+}
+
+int mapped_writer::overflow(int ch)
+{
+	if (map_ && !grow_) {
+		// the output is larger than measured
+		error_ = EFBIG;
+		return traits_type::eof();
+	}
+	if (map_ ? error_ || !grow() : fd_ < 0 || !flush()) {
+		return traits_type::eof();
+	}
+	if (ch != traits_type::eof()) {
+		*pptr() = ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+int mapped_writer::sync()
+{
+	return flush() ? 0 : -1;
+}
+
+int mapped_writer::finish()
+{
+	if (fd_ < 0) {
+		return error_;
+	}
+
+	if (map_) {
+		std::size_t written(pptr() - pbase());
+		::munmap(map_, size_);
+		map_ = nullptr;
+		if (written != size_ && ::ftruncate(fd_, written) != 0 && !error_) {
+			error_ = errno;
+		}
+	} else {
+		flush();
+	}
+	setp(nullptr, nullptr);
+
+	if (::close(fd_) != 0 && !error_) {
+		error_ = errno;
+	}
+	fd_ = -1;
+	return error_;
+}
+
+void mapped_writer::close()
+{
+	if (int err = finish()) {
+		throw std::system_error(err, std::system_category(), "lccc: mapped_writer");
+	}
+}
+
+}
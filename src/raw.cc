@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/hash.h>
+#include <lccc/raw.h>
+#include <lccc/snapshot.h>
+
+#include <cerrno>
+#include <ostream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+class mapping {
+public:
+	mapping(void * addr, std::size_t size)
+	:
+		addr_(addr),
+		size_(size)
+	{ }
+
+	~mapping()
+	{
+		::munmap(addr_, size_);
+	}
+
+	char const* data() const
+	{
+		return static_cast<char const*>(addr_);
+	}
+
+private:
+	void * addr_;
+	std::size_t size_;
+};
+
+}
+
+namespace lccc {
+
+raw::ptr_t raw::make(char const* data, std::size_t size)
+{
+	return ptr_t(new raw(nullptr, data, size));
+}
+
+raw::ptr_t raw::make(std::string const& text)
+{
+	auto copy(std::make_shared<std::string const>(text));
+	return ptr_t(new raw(copy, copy->data(), copy->size()));
+}
+
+raw::ptr_t raw::map(std::string const& path)
+{
+	int fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+	if (fd < 0) {
+		throw std::system_error(errno, std::system_category(), path);
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		int err(errno);
+		::close(fd);
+		throw std::system_error(err, std::system_category(), path);
+	}
+
+	if (st.st_size == 0) {
+		::close(fd);
+		return make(nullptr, 0);
+	}
+
+	void * addr(::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+	int err(errno);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		throw std::system_error(err, std::system_category(), path);
+	}
+
+	auto map(std::make_shared<mapping>(addr, st.st_size));
+	return ptr_t(new raw(map, map->data(), st.st_size));
+}
+
+raw::raw(std::shared_ptr<void const> const& owner, char const* data, std::size_t size)
+:
+	owner_(owner),
+	data_(data),
+	size_(size)
+{ }
+
+std::ostream & raw::print(std::ostream & os) const
+{
+	return os.write(data_, size_);
+}
+
+bool raw::hash(hasher & h) const
+{
+	h.add("raw").add(data_, size_);
+	return true;
+}
+
+bool raw::write(snapshot_writer & w) const
+{
+	w.node(snapshot::kind::raw, 0, {std::string(data_, size_)}, {});
+	return true;
+}
+
+char const* raw::data() const
+{
+	return data_;
+}
+
+std::size_t raw::size() const
+{
+	return size_;
+}
+
+}
@@ -0,0 +1,189 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/cache.h>
+#include <lccc/hash.h>
+
+#include <sstream>
+
+namespace {
+
+int stream_index()
+{
+	static int index(std::ios_base::xalloc());
+	return index;
+}
+
+// fragments on disk start with their check value
+std::string encode(std::uint64_t check)
+{
+	std::string res(8, '\0');
+	for (auto & c: res) {
+		c = char(check & 0xff);
+		check >>= 8;
+	}
+	return res;
+}
+
+}
+
+namespace lccc {
+
+render_cache::stats::stats()
+:
+	hits(0),
+	disk_hits(0),
+	misses(0),
+	bytes_saved(0),
+	bytes_cached(0)
+{ }
+
+double render_cache::stats::hit_rate() const
+{
+	auto lookups(hits + misses);
+	return lookups ? double(hits) / lookups : 0.0;
+}
+
+render_cache::ptr_t render_cache::make()
+{
+	return ptr_t(new render_cache(nullptr));
+}
+
+render_cache::ptr_t render_cache::make(disk_cache::ptr_t const& disk)
+{
+	return ptr_t(new render_cache(disk));
+}
+
+render_cache::render_cache(disk_cache::ptr_t const& disk)
+:
+	disk_(disk),
+	depth_(0)
+{ }
+
+render_cache * render_cache::get(std::ostream & os)
+{
+	return static_cast<render_cache *>(os.pword(stream_index()));
+}
+
+void render_cache::attach(std::ostream & os)
+{
+	os.pword(stream_index()) = this;
+}
+
+void render_cache::detach(std::ostream & os)
+{
+	if (get(os) == this) {
+		os.pword(stream_index()) = nullptr;
+	}
+}
+
+std::ostream & render_cache::print(src const& node, std::ostream & os)
+{
+	hasher h(&digests_);
+	h.add(version);
+	if (!h.add(node)) {
+		// the children are looked up on their own, lazy nodes among
+		// them release what they print
+		if (depth_ == 0) {
+			digests_.clear();
+		}
+		return node.print(os);
+	}
+
+	auto key(h.value());
+	auto check(h.check());
+	auto it(fragments_.find(key));
+	if ((it != fragments_.end() && it->second.check == check) || load(key, check)) {
+		it = fragments_.find(key);
+		++stats_.hits;
+		stats_.bytes_saved += it->second.text.size();
+		os << it->second.text;
+	} else {
+		render(node, os, key, check);
+	}
+
+	if (depth_ == 0) {
+		digests_.clear();
+	}
+	return os;
+}
+
+bool render_cache::load(std::uint64_t key, std::uint64_t check)
+{
+	std::string text;
+	if (!disk_ || fragments_.count(key) || !disk_->load(key, text) ||
+	    text.compare(0, 8, encode(check)) != 0) {
+		return false;
+	}
+
+	fragments_[key] = fragment{check, text.substr(8)};
+	++stats_.disk_hits;
+	return true;
+}
+
+std::ostream & render_cache::render(src const& node, std::ostream & os,
+	std::uint64_t key, std::uint64_t check)
+{
+	std::stringstream out;
+	attach(out);
+	++depth_;
+	try {
+		node.print(out);
+	} catch (...) {
+		if (--depth_ == 0) {
+			digests_.clear();
+		}
+		throw;
+	}
+	--depth_;
+
+	++stats_.misses;
+	// a different fragment under the same key is not replaced
+	auto res(fragments_.emplace(key, fragment{check, out.str()}));
+	if (!res.second) {
+		return os << out.str();
+	}
+
+	auto const& text(res.first->second.text);
+	stats_.bytes_cached += text.size();
+	if (disk_ && text.size() + 8 >= disk_->min_size()) {
+		disk_->store(key, encode(check) + text);
+	}
+	return os << text;
+}
+
+render_cache::stats render_cache::statistics() const
+{
+	return stats_;
+}
+
+void render_cache::clear()
+{
+	fragments_.clear();
+	digests_.clear();
+	stats_ = stats();
+}
+
+}
@@ -0,0 +1,187 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/renderer.h>
+
+#include <algorithm>
+#include <ostream>
+
+namespace {
+
+// unwinds the print traversal once the renderer is destroyed
+struct cancelled { };
+
+}
+
+namespace lccc {
+
+renderer::chunk::chunk(char const* data, std::size_t size)
+:
+	data_(data),
+	size_(size)
+{ }
+
+char const* renderer::chunk::data() const
+{
+	return data_;
+}
+
+std::size_t renderer::chunk::size() const
+{
+	return size_;
+}
+
+renderer::chunk::operator bool() const
+{
+	return size_ != 0;
+}
+
+renderer::buffer::buffer(renderer & owner)
+:
+	owner_(owner)
+{
+	setp(area_, area_ + sizeof(area_));
+}
+
+renderer::buffer::~buffer()
+{ }
+
+void renderer::buffer::flush()
+{
+	auto size(pptr() - pbase());
+	setp(area_, area_ + sizeof(area_));
+	owner_.push(area_, size);
+}
+
+int renderer::buffer::overflow(int ch)
+{
+	flush();
+	if (ch != traits_type::eof()) {
+		*pptr() = ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+int renderer::buffer::sync()
+{
+	flush();
+	return 0;
+}
+
+renderer::renderer(src::ptr_t const& root, std::size_t capacity)
+:
+	root_(root),
+	capacity_(std::max(capacity, std::size_t(1))),
+	offset_(0),
+	started_(false),
+	done_(false),
+	cancel_(false)
+{ }
+
+renderer::~renderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		cancel_ = true;
+	}
+	cond_.notify_all();
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+void renderer::run()
+{
+	buffer buf(*this);
+	try {
+		std::ostream os(&buf);
+		// streams swallow exceptions of their buffer into badbit, and
+		// indent clears the state when it swaps buffers
+		os.exceptions(std::ios::badbit);
+		root_->print(os);
+	} catch (cancelled const&) {
+		return;
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		error_ = std::current_exception();
+	}
+	// the output printed before an error is still delivered
+	try {
+		buf.pubsync();
+	} catch (cancelled const&) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		done_ = true;
+	}
+	cond_.notify_all();
+}
+
+void renderer::push(char const* data, std::size_t size)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	cond_.wait(lock, [this] { return cancel_ || pending_.size() - offset_ < capacity_; });
+	if (cancel_) {
+		throw cancelled();
+	}
+
+	if (offset_ != 0) {
+		pending_.erase(0, offset_);
+		offset_ = 0;
+	}
+	pending_.append(data, size);
+	lock.unlock();
+	cond_.notify_all();
+}
+
+renderer::chunk renderer::next(std::size_t max)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (!started_) {
+		started_ = true;
+		thread_ = std::thread(&renderer::run, this);
+	}
+
+	// at least capacity bytes unless the tree is printed completely
+	auto want(std::max(std::min(max, capacity_), std::size_t(1)));
+	cond_.wait(lock, [this, want] { return done_ || pending_.size() - offset_ >= want; });
+	if (pending_.size() == offset_ && error_) {
+		auto error(error_);
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+
+	auto size(std::min(max, pending_.size() - offset_));
+	current_.assign(pending_, offset_, size);
+	offset_ += size;
+	lock.unlock();
+	cond_.notify_all();
+	return chunk(current_.data(), current_.size());
+}
+
+}
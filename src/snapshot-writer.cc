@@ -0,0 +1,134 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/snapshot.h>
+
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+template <typename T>
+T narrow(std::size_t value)
+{
+	if (value > std::numeric_limits<T>::max()) {
+		throw std::length_error("lccc: tree too large for a snapshot");
+	}
+	return value;
+}
+
+}
+
+namespace lccc {
+
+snapshot_writer::snapshot_writer()
+:
+	last_(0)
+{ }
+
+snapshot_writer::~snapshot_writer()
+{ }
+
+std::uint32_t snapshot_writer::add(src const& node)
+{
+	if (!node.write(*this)) {
+		throw std::invalid_argument("lccc: node can not be stored in a snapshot");
+	}
+
+	sources_.resize(records_.size());
+	sources_[last_] = &node;
+	return last_;
+}
+
+std::uint32_t snapshot_writer::intern(std::string const& str)
+{
+	auto it(interned_.find(str));
+	if (it != interned_.end()) {
+		return it->second;
+	}
+
+	auto offset(narrow<std::uint32_t>(strings_.size()));
+	narrow<std::uint32_t>(strings_.size() + str.size());
+	strings_.append(str);
+	interned_.emplace(str, offset);
+	return offset;
+}
+
+void snapshot_writer::node(snapshot::kind type, std::uint8_t flags,
+	std::vector<std::string> const& fields,
+	std::vector<std::uint32_t> const& children)
+{
+	snapshot::record rec;
+	rec.type = static_cast<std::uint8_t>(type);
+	rec.flags = flags;
+	rec.nfields = narrow<std::uint16_t>(fields.size());
+	rec.field = narrow<std::uint32_t>(fields_.size());
+	rec.child = narrow<std::uint32_t>(children_.size());
+	rec.nchildren = narrow<std::uint32_t>(children.size());
+	narrow<std::uint32_t>(fields_.size() + fields.size());
+	narrow<std::uint32_t>(children_.size() + children.size());
+
+	for (auto const& str: fields) {
+		snapshot::field field;
+		field.offset = intern(str);
+		field.size = narrow<std::uint32_t>(str.size());
+		fields_.push_back(field);
+	}
+	children_.insert(children_.end(), children.begin(), children.end());
+
+	last_ = narrow<std::uint32_t>(records_.size());
+	records_.push_back(rec);
+}
+
+std::ostream & snapshot_writer::write(std::ostream & os, std::uint32_t root) const
+{
+	snapshot::file_header hdr;
+	std::memcpy(hdr.magic, snapshot::magic, sizeof(hdr.magic));
+	hdr.version = snapshot::version;
+	hdr.root = root;
+	hdr.records = records_.size();
+	hdr.fields = fields_.size();
+	hdr.children = children_.size();
+	hdr.strings = strings_.size();
+
+	os.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+	os.write(reinterpret_cast<char const*>(records_.data()),
+		records_.size() * sizeof(snapshot::record));
+	os.write(reinterpret_cast<char const*>(fields_.data()),
+		fields_.size() * sizeof(snapshot::field));
+	os.write(reinterpret_cast<char const*>(children_.data()),
+		children_.size() * sizeof(std::uint32_t));
+	os.write(strings_.data(), strings_.size());
+	return os;
+}
+
+src const* snapshot_writer::source(std::uint32_t index) const
+{
+	return index < sources_.size() ? sources_[index] : nullptr;
+}
+
+}
@@ -0,0 +1,798 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/cc.h>
+#include <lccc/header.h>
+#include <lccc/raw.h>
+#include <lccc/snapshot.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void corrupt()
+{
+	throw std::runtime_error("lccc: corrupt snapshot");
+}
+
+}
+
+namespace lccc {
+
+char const snapshot::magic[8] = {'L', 'C', 'C', 'C', 'S', 'N', 'A', 'P'};
+
+snapshot::node::node(snapshot const* snap, std::uint32_t index)
+:
+	snapshot_(snap),
+	index_(index)
+{ }
+
+snapshot::record const& snapshot::node::rec() const
+{
+	return snapshot_->records_[index_];
+}
+
+std::uint32_t snapshot::node::index() const
+{
+	return index_;
+}
+
+snapshot::kind snapshot::node::type() const
+{
+	return static_cast<kind>(rec().type);
+}
+
+std::uint8_t snapshot::node::flags() const
+{
+	return rec().flags;
+}
+
+std::size_t snapshot::node::fields() const
+{
+	return rec().nfields;
+}
+
+text_ref snapshot::node::field(std::size_t n) const
+{
+	auto const& f(snapshot_->fields_[rec().field + n]);
+	return text_ref(snapshot_->strings_ + f.offset, f.size);
+}
+
+std::size_t snapshot::node::children() const
+{
+	return rec().nchildren;
+}
+
+snapshot::node snapshot::node::child(std::size_t n) const
+{
+	return node(snapshot_, snapshot_->children_[rec().child + n]);
+}
+
+snapshot::snapshot()
+:
+	map_(nullptr),
+	map_size_(0),
+	data_(nullptr),
+	size_(0),
+	header_(nullptr),
+	records_(nullptr),
+	fields_(nullptr),
+	children_(nullptr),
+	strings_(nullptr)
+{ }
+
+snapshot::~snapshot()
+{
+	if (map_) {
+		::munmap(map_, map_size_);
+	}
+}
+
+snapshot::ptr_t snapshot::open(std::string const& path)
+{
+	ptr_t snap(new snapshot());
+	int fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+	if (fd < 0) {
+		throw std::system_error(errno, std::system_category(), path);
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		int err(errno);
+		::close(fd);
+		throw std::system_error(err, std::system_category(), path);
+	}
+
+	snap->map_size_ = st.st_size;
+	if (snap->map_size_ != 0) {
+		void * map(::mmap(nullptr, snap->map_size_, PROT_READ, MAP_PRIVATE, fd, 0));
+		if (map == MAP_FAILED) {
+			int err(errno);
+			::close(fd);
+			throw std::system_error(err, std::system_category(), path);
+		}
+		snap->map_ = map;
+	}
+	::close(fd);
+
+	snap->data_ = static_cast<char const*>(snap->map_);
+	snap->size_ = snap->map_size_;
+	snap->validate();
+	return snap;
+}
+
+snapshot::ptr_t snapshot::make(std::string const& data)
+{
+	ptr_t snap(new snapshot());
+	snap->buffer_ = data;
+	snap->data_ = snap->buffer_.data();
+	snap->size_ = snap->buffer_.size();
+	snap->validate();
+	return snap;
+}
+
+std::ostream & snapshot::write(src const& root, std::ostream & os)
+{
+	snapshot_writer w;
+	auto index(w.add(root));
+	return w.write(os, index);
+}
+
+void snapshot::validate()
+{
+	if (size_ < sizeof(file_header)) {
+		corrupt();
+	}
+
+	header_ = reinterpret_cast<file_header const*>(data_);
+	if (std::memcmp(header_->magic, magic, sizeof(magic)) != 0 ||
+	    header_->version != version) {
+		corrupt();
+	}
+
+	std::uint64_t size(sizeof(file_header));
+	size += std::uint64_t(header_->records) * sizeof(record);
+	size += std::uint64_t(header_->fields) * sizeof(field);
+	size += std::uint64_t(header_->children) * sizeof(std::uint32_t);
+	size += header_->strings;
+	if (size != size_ || header_->root >= header_->records) {
+		corrupt();
+	}
+
+	auto pos(data_ + sizeof(file_header));
+	records_ = reinterpret_cast<record const*>(pos);
+	pos += header_->records * sizeof(record);
+	fields_ = reinterpret_cast<field const*>(pos);
+	pos += header_->fields * sizeof(field);
+	children_ = reinterpret_cast<std::uint32_t const*>(pos);
+	pos += header_->children * sizeof(std::uint32_t);
+	strings_ = pos;
+
+	for (std::uint32_t i(0); i < header_->records; ++i) {
+		auto const& rec(records_[i]);
+		if (std::uint64_t(rec.field) + rec.nfields > header_->fields ||
+		    std::uint64_t(rec.child) + rec.nchildren > header_->children) {
+			corrupt();
+		}
+		// children are always written before their parent
+		for (std::uint32_t c(0); c < rec.nchildren; ++c) {
+			if (children_[rec.child + c] >= i) {
+				corrupt();
+			}
+		}
+	}
+
+	for (std::uint32_t i(0); i < header_->fields; ++i) {
+		if (std::uint64_t(fields_[i].offset) + fields_[i].size > header_->strings) {
+			corrupt();
+		}
+	}
+}
+
+snapshot::node snapshot::root() const
+{
+	return node(this, header_->root);
+}
+
+snapshot::node snapshot::at(std::uint32_t index) const
+{
+	if (index >= header_->records) {
+		throw std::out_of_range("lccc: snapshot record out of range");
+	}
+	return node(this, index);
+}
+
+std::size_t snapshot::size() const
+{
+	return header_->records;
+}
+
+namespace {
+
+void check(snapshot::node const& n, std::size_t fields)
+{
+	if (n.fields() < fields) {
+		corrupt();
+	}
+}
+
+template <typename T>
+std::shared_ptr<T> load_as(snapshot const& snap, snapshot::node const& n)
+{
+	auto res(std::dynamic_pointer_cast<T>(snap.load(n)));
+	if (!res) {
+		corrupt();
+	}
+	return res;
+}
+
+void load_args(cc_method_base & method, snapshot::node const& n, std::size_t first)
+{
+	for (auto i(first); i + 1 < n.fields(); i += 2) {
+		method.add_arg(n.field(i).str(), n.field(i + 1).str());
+	}
+}
+
+void load_src(snapshot const& snap, cc_method_base & method, snapshot::node const& n, std::size_t first)
+{
+	if (n.children() > first) {
+		method.define(load_as<cc_block>(snap, n.child(first)));
+	}
+}
+
+void load_visibility(snapshot const& snap, cc_class::visibility & vis, snapshot::node const& n)
+{
+	for (std::size_t i(0); i < n.children(); ++i) {
+		auto child(snap.load(n.child(i)));
+		if (auto method = std::dynamic_pointer_cast<cc_method>(child)) {
+			vis.add(method);
+		} else if (auto member = std::dynamic_pointer_cast<cc_member>(child)) {
+			vis.add(member);
+		} else if (auto ctor = std::dynamic_pointer_cast<cc_class::constructor>(child)) {
+			vis.add(ctor);
+		} else if (auto dtor = std::dynamic_pointer_cast<cc_class::destructor>(child)) {
+			vis.add(dtor);
+		} else if (auto text = std::dynamic_pointer_cast<raw>(child)) {
+			vis.add(text);
+		} else if (auto array = std::dynamic_pointer_cast<cc_array>(child)) {
+			vis.add(array);
+		} else if (auto e = std::dynamic_pointer_cast<cc_enum>(child)) {
+			vis.add(e);
+		} else if (auto cls = std::dynamic_pointer_cast<cc_class>(child)) {
+			vis.add(cls);
+		} else {
+			corrupt();
+		}
+	}
+}
+
+std::size_t number(text_ref field)
+{
+	if (field.empty() || field.size() > 19) {
+		corrupt();
+	}
+	std::size_t res(0);
+	for (std::size_t i(0); i < field.size(); ++i) {
+		auto c(field.data()[i]);
+		if (c < '0' || c > '9') {
+			corrupt();
+		}
+		res = res * 10 + (c - '0');
+	}
+	return res;
+}
+
+// attributes are stored separated by newlines
+std::vector<text_ref> lines(text_ref field)
+{
+	std::vector<text_ref> res;
+	auto begin(field.data());
+	auto end(begin + field.size());
+	while (begin != end) {
+		auto pos(std::find(begin, end, '\n'));
+		res.emplace_back(begin, pos - begin);
+		begin = pos == end ? end : pos + 1;
+	}
+	return res;
+}
+
+// the block of a method follows all its other children
+bool body(snapshot::node const& n, std::size_t first, text_ref & source)
+{
+	if (n.children() <= first) {
+		return false;
+	}
+	auto block(n.child(first));
+	if (block.type() != snapshot::kind::cc_block || block.fields() < 1) {
+		corrupt();
+	}
+	source = block.field(0);
+	return true;
+}
+
+// qualifiers, attributes and the noexcept condition in front of the
+// arguments
+void load_base(cc_method_base & method, snapshot::node const& n, std::size_t first)
+{
+	check(n, first + 3);
+	auto qualifiers(number(n.field(first)));
+	if (qualifiers & 1) {
+		method.make_noexcept(n.field(first + 2).str());
+	}
+	if (qualifiers & 2) {
+		method.make_constexpr();
+	}
+	if (qualifiers & 4) {
+		method.make_inline();
+	}
+	if (qualifiers & 8) {
+		method.make_default();
+	}
+	if (qualifiers & 16) {
+		method.make_delete();
+	}
+
+	for (auto const& attribute: lines(n.field(first + 1))) {
+		method.add_attribute(attribute.str());
+	}
+
+	load_args(method, n, first + 3);
+}
+
+template <typename T>
+cc_array::ptr_t load_elements(snapshot::node const& n)
+{
+	auto bytes(n.field(5));
+	if (bytes.size() % sizeof(T) != 0) {
+		corrupt();
+	}
+	std::vector<T> data(bytes.size() / sizeof(T));
+	if (!data.empty()) {
+		std::memcpy(data.data(), bytes.data(), bytes.size());
+	}
+	return cc_array::make(n.field(0).str(), n.field(1).str(), data);
+}
+
+src::ptr_t load_array(snapshot::node const& n)
+{
+	check(n, 6);
+	cc_array::ptr_t array;
+	switch (cc_array::element(number(n.field(2)))) {
+	case cc_array::element::int8: array = load_elements<std::int8_t>(n); break;
+	case cc_array::element::int16: array = load_elements<std::int16_t>(n); break;
+	case cc_array::element::int32: array = load_elements<std::int32_t>(n); break;
+	case cc_array::element::int64: array = load_elements<std::int64_t>(n); break;
+	case cc_array::element::uint8: array = load_elements<std::uint8_t>(n); break;
+	case cc_array::element::uint16: array = load_elements<std::uint16_t>(n); break;
+	case cc_array::element::uint32: array = load_elements<std::uint32_t>(n); break;
+	case cc_array::element::uint64: array = load_elements<std::uint64_t>(n); break;
+	case cc_array::element::float32: array = load_elements<float>(n); break;
+	case cc_array::element::float64: array = load_elements<double>(n); break;
+	default: corrupt();
+	}
+
+	if (n.flags() & 1) {
+		array->make_static();
+	}
+	if (n.flags() & 2) {
+		array->make_constexpr();
+	}
+	if (n.flags() & 4) {
+		array->make_hex();
+	}
+	array->align(number(n.field(3)));
+	array->wrap(number(n.field(4)));
+	return array;
+}
+
+src::ptr_t load_member(snapshot::node const& n)
+{
+	check(n, 5);
+	auto member(cc_member::make(n.field(0).str(), n.field(1).str()));
+	if (n.flags() & 1) {
+		member->make_hot();
+	}
+	if (n.flags() & 2) {
+		member->make_cold();
+	}
+	member->align(number(n.field(2)));
+	member->layout(number(n.field(3)), number(n.field(4)));
+	if (n.fields() > 5) {
+		member->pack(number(n.field(5)));
+	}
+	return member;
+}
+
+cc_enum::ptr_t load_enum(snapshot::node const& n)
+{
+	check(n, 2);
+	auto e(cc_enum::make(n.field(0).str(), n.field(1).str()));
+	if (n.flags() & 1) {
+		e->make_scoped();
+	}
+	for (std::size_t i(2); i + 1 < n.fields(); i += 2) {
+		auto value(n.field(i + 1));
+		if (value.empty()) {
+			e->add(n.field(i).str());
+		} else if (value.data()[0] == '-') {
+			auto magnitude(number(text_ref(value.data() + 1, value.size() - 1)));
+			e->add(n.field(i).str(), std::int64_t(0 - std::uint64_t(magnitude)));
+		} else {
+			e->add(n.field(i).str(), std::int64_t(number(value)));
+		}
+	}
+	return e;
+}
+
+src::ptr_t load_class(snapshot const& snap, snapshot::node const& n)
+{
+	check(n, 1);
+	auto cls(cc_class::make(n.field(0).str()));
+	if (n.flags() & 1) {
+		cls->make_final();
+	}
+	for (std::size_t i(1); i < n.fields(); ++i) {
+		cls->add_template_parameter(n.field(i).str());
+	}
+	for (std::size_t i(0); i < n.children(); ++i) {
+		auto child(n.child(i));
+		if (child.type() == snapshot::kind::cc_base_class) {
+			cls->add(load_as<cc_base_class>(snap, child));
+			continue;
+		}
+
+		check(child, 1);
+		auto keyword(child.field(0));
+		if (child.type() != snapshot::kind::cc_visibility) {
+			corrupt();
+		} else if (keyword == "public") {
+			load_visibility(snap, *cls->vpublic(), child);
+		} else if (keyword == "protected") {
+			load_visibility(snap, *cls->vprotected(), child);
+		} else if (keyword == "private") {
+			load_visibility(snap, *cls->vprivate(), child);
+		} else {
+			corrupt();
+		}
+	}
+	return cls;
+}
+
+// the guard define is created by cpp_guard itself
+snapshot::node guard_condition(snapshot::node const& n)
+{
+	if (n.children() != 1) {
+		corrupt();
+	}
+
+	auto cond(n.child(0));
+	if (cond.type() != snapshot::kind::cpp_condition || cond.fields() < 2 ||
+	    cond.children() < 1) {
+		corrupt();
+	}
+	return cond;
+}
+
+}
+
+src::ptr_t snapshot::load() const
+{
+	return load(root());
+}
+
+src::ptr_t snapshot::load(node const& n) const
+{
+	switch (n.type()) {
+	case kind::cc_block: {
+		check(n, 1);
+		auto block(cc_block::make());
+		block->src() << n.field(0);
+		return block;
+	}
+	case kind::cc_method: {
+		check(n, 2);
+		auto method(cc_method::make(n.field(0).str(), n.field(1).str()));
+		load_base(*method, n, 2);
+		load_src(*this, *method, n, 0);
+		if (n.flags() & 2) {
+			method->make_abstract();
+		} else if (n.flags() & 1) {
+			method->make_virtual();
+		}
+		if (n.flags() & 4) {
+			method->make_const();
+		}
+		if (n.flags() & 8) {
+			method->make_final();
+		}
+		if (n.flags() & 16) {
+			method->make_static();
+		}
+		return method;
+	}
+	case kind::cc_namespace: {
+		check(n, 1);
+		auto ns(cc_namespace::make(n.field(0).str()));
+		for (std::size_t i(0); i < n.children(); ++i) {
+			ns->add(load(n.child(i)));
+		}
+		return ns;
+	}
+	case kind::cc_member:
+		return load_member(n);
+	case kind::cc_base_class:
+		check(n, 1);
+		return cc_base_class::make(n.field(0).str());
+	case kind::cc_initializer:
+		check(n, 2);
+		return cc_base_class::make(n.field(0).str())->make_initializer(n.field(1).str());
+	case kind::cc_constructor: {
+		check(n, 1);
+		auto ctor(cc_class::make(n.field(0).str())->make_constructor());
+		load_base(*ctor, n, 1);
+		std::size_t i(0);
+		for (; i < n.children() && n.child(i).type() == kind::cc_initializer; ++i) {
+			ctor->add(load_as<cc_base_class::initializer>(*this, n.child(i)));
+		}
+		load_src(*this, *ctor, n, i);
+		return ctor;
+	}
+	case kind::cc_destructor: {
+		check(n, 1);
+		auto dtor(cc_class::make(n.field(0).str())->make_destructor());
+		load_base(*dtor, n, 1);
+		load_src(*this, *dtor, n, 0);
+		if (n.flags() & 1) {
+			dtor->make_virtual();
+		}
+		if (n.flags() & 2) {
+			dtor->make_final();
+		}
+		return dtor;
+	}
+	case kind::cc_class:
+		return load_class(*this, n);
+	case kind::cpp_define:
+		check(n, 1);
+		return cpp_define::make(n.field(0).str());
+	case kind::cpp_include:
+		check(n, 1);
+		if (n.flags() & 1) {
+			return cpp_include::make_local(n.field(0).str());
+		}
+		return cpp_include::make(n.field(0).str());
+	case kind::cpp_condition: {
+		check(n, 2);
+		cpp_condition::ptr_t cond;
+		if (n.field(0) == "#ifdef") {
+			cond = cpp_ifdef::make(n.field(1).str());
+		} else if (n.field(0) == "#ifndef") {
+			cond = cpp_ifndef::make(n.field(1).str());
+		} else {
+			corrupt();
+		}
+		for (std::size_t i(0); i < n.children(); ++i) {
+			cond->add(load(n.child(i)));
+		}
+		return cond;
+	}
+	case kind::cpp_guard: {
+		auto cond(guard_condition(n));
+		auto guard(cpp_guard::make(cond.field(1).str()));
+		for (std::size_t i(1); i < cond.children(); ++i) {
+			guard->add(load(cond.child(i)));
+		}
+		return guard;
+	}
+	case kind::header: {
+		check(n, 1);
+		if (n.children() != 1 || n.child(0).type() != kind::cpp_guard) {
+			corrupt();
+		}
+		auto cond(guard_condition(n.child(0)));
+		auto hdr(header::make(n.field(0).str()));
+		if (n.flags() & 1) {
+			hdr->make_deterministic();
+		}
+		for (std::size_t i(1); i < cond.children(); ++i) {
+			hdr->add(load(cond.child(i)));
+		}
+		return hdr;
+	}
+	case kind::raw:
+		check(n, 1);
+		return raw::make(n.field(0).str());
+	case kind::cc_array:
+		return load_array(n);
+	case kind::cc_enum: {
+		auto e(load_enum(n));
+		e->member_ = n.flags() & 2;
+		return e;
+	}
+	case kind::cc_visibility:
+		break;
+	}
+
+	corrupt();
+	return nullptr;
+}
+
+std::ostream & snapshot::print(std::ostream & os) const
+{
+	return print(root(), os);
+}
+
+std::ostream & snapshot::print(node const& n, std::ostream & os) const
+{
+	auto content = [&n, &os] {
+		for (std::size_t i(0); i < n.children(); ++i) {
+			n.snapshot_->print(n.child(i), os);
+		}
+	};
+	// name, qualifiers, attributes, noexcept condition and arguments
+	// from the given field on
+	auto declare = [&n](std::size_t first) {
+		check(n, first + 4);
+		cc_method_base::declaration decl(n.field(first), number(n.field(first + 1)));
+		decl.attributes = lines(n.field(first + 2));
+		decl.condition = n.field(first + 3);
+		for (auto i(first + 4); i + 1 < n.fields(); i += 2) {
+			decl.args.push_back(n.field(i));
+			decl.args.push_back(n.field(i + 1));
+		}
+		return decl;
+	};
+	text_ref source("");
+	cc_method_base::body_t block;
+	auto define = [&block, &source, &os] {
+		block = [&source, &os] { cc_block::format(os, source); };
+	};
+
+	switch (n.type()) {
+	case kind::cc_block:
+		check(n, 1);
+		return cc_block::format(os, n.field(0));
+	case kind::cc_method: {
+		check(n, 1);
+		auto decl(declare(1));
+		if (body(n, 0, source)) {
+			define();
+		}
+		return cc_method::format(os, decl, n.field(0), n.flags(), block);
+	}
+	case kind::cc_namespace:
+		check(n, 1);
+		return cc_namespace::format(os, n.field(0), content);
+	case kind::cc_member:
+		check(n, 5);
+		return cc_member::format(os, n.field(0), n.field(1), number(n.field(2)));
+	case kind::cc_base_class:
+		check(n, 1);
+		return os << n.field(0);
+	case kind::cc_initializer:
+		check(n, 2);
+		return cc_base_class::initializer::format(os, n.field(0), n.field(1));
+	case kind::cc_constructor: {
+		auto decl(declare(0));
+		std::size_t initializers(0);
+		while (initializers < n.children() &&
+		       n.child(initializers).type() == kind::cc_initializer) {
+			++initializers;
+		}
+		if (body(n, initializers, source)) {
+			define();
+		}
+		auto initializer = [&n, &os](std::size_t i) {
+			auto init(n.child(i));
+			check(init, 2);
+			cc_base_class::initializer::format(os, init.field(0), init.field(1));
+		};
+		return cc_class::constructor::format(os, decl, initializers, initializer, block);
+	}
+	case kind::cc_destructor: {
+		auto decl(declare(0));
+		if (body(n, 0, source)) {
+			define();
+		}
+		return cc_class::destructor::format(os, decl, n.flags(), block);
+	}
+	case kind::cc_visibility:
+		check(n, 1);
+		return cc_class::visibility::format(os, n.field(0), n.children() == 0, content);
+	case kind::cc_class: {
+		check(n, 1);
+		std::vector<text_ref> parameters;
+		for (std::size_t i(1); i < n.fields(); ++i) {
+			parameters.push_back(n.field(i));
+		}
+		std::size_t bases(0);
+		while (bases < n.children() && n.child(bases).type() == kind::cc_base_class) {
+			++bases;
+		}
+		auto base = [&n, &os](std::size_t i) {
+			auto b(n.child(i));
+			check(b, 1);
+			os << b.field(0);
+		};
+		auto sections = [&n, &os, bases] {
+			for (auto i(bases); i < n.children(); ++i) {
+				if (n.child(i).type() != kind::cc_visibility) {
+					corrupt();
+				}
+				n.snapshot_->print(n.child(i), os);
+			}
+		};
+		return cc_class::format(os, n.field(0), n.flags() & 1, parameters, bases, base, sections);
+	}
+	case kind::cpp_define:
+		check(n, 1);
+		return cpp_define::format(os, n.field(0));
+	case kind::cpp_include:
+		check(n, 1);
+		return cpp_include::format(os, n.field(0), n.flags() & 1);
+	case kind::cpp_condition:
+		check(n, 2);
+		return cpp_condition::format(os, n.field(0), n.field(1), content);
+	case kind::cpp_guard:
+		return print(guard_condition(n), os);
+	case kind::header:
+		if (n.children() != 1 || n.child(0).type() != kind::cpp_guard) {
+			corrupt();
+		}
+		return print(n.child(0), os);
+	case kind::raw:
+		check(n, 1);
+		return os << n.field(0);
+	case kind::cc_array: {
+		check(n, 6);
+		auto elem(cc_array::element(number(n.field(2))));
+		auto width(cc_array::width(elem));
+		auto bytes(n.field(5));
+		if (width == 0 || bytes.size() % width != 0) {
+			corrupt();
+		}
+		return cc_array::format(os, n.field(0), n.field(1), elem, bytes.data(),
+			bytes.size() / width, n.flags(), number(n.field(3)), number(n.field(4)));
+	}
+	case kind::cc_enum:
+		// the conversions are generated through nodes anyway
+		return load(n)->print(os);
+	}
+
+	corrupt();
+	return os;
+}
+
+}
@@ -0,0 +1,261 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/raw.h>
+#include <lccc/soa.h>
+
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+struct column {
+	std::string type;
+	std::string member;
+	std::string name;
+	std::string storage;
+};
+
+std::vector<column> columns(lccc::cc_class const& cls)
+{
+	std::vector<column> res;
+	for (auto const& member: cls.members()) {
+		if (member->is_static()) {
+			continue;
+		}
+		auto name(member->name());
+		if (name.size() > 1 && name.back() == '_') {
+			name.pop_back();
+		}
+		res.push_back(column{member->type(), member->name(), name, name + "_"});
+	}
+	return res;
+}
+
+lccc::cc_base_class::initializer::ptr_t init(std::string const& member, std::string const& value)
+{
+	return lccc::cc_base_class::make(member)->make_initializer(value);
+}
+
+}
+
+namespace lccc {
+
+cc_soa::ptr_t cc_soa::make(cc_class::ptr_t const& cls, std::string const& name)
+{
+	return ptr_t(new cc_soa(cls, name));
+}
+
+cc_soa::cc_soa(cc_class::ptr_t const& cls, std::string const& name)
+:
+	class_(cls),
+	name_(name),
+	align_(64)
+{ }
+
+void cc_soa::align(std::size_t alignment)
+{
+	if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+		throw std::invalid_argument("lccc: alignment " + std::to_string(alignment)
+			+ " is no power of two of at least " + std::to_string(sizeof(void*)));
+	}
+	align_ = alignment;
+}
+
+cc_class::ptr_t cc_soa::generate() const
+{
+	auto cols(columns(*class_));
+	if (cols.empty()) {
+		throw std::invalid_argument("lccc: no data members in " + class_->name());
+	}
+	std::set<std::string> names{name_, "reference", "owner_", "index_", "size", "size_",
+		"capacity", "capacity_", "reserve", "resize", "push_back", "erase_swap", "allocate"};
+	for (auto const& col: cols) {
+		if (!names.insert(col.name).second || !names.insert(col.storage).second) {
+			throw std::invalid_argument("lccc: member " + col.member + " of " + class_->name()
+				+ " collides with another name in " + name_);
+		}
+	}
+
+	auto soa(cc_class::make(name_));
+	auto pub(soa->vpublic());
+	auto priv(soa->vprivate());
+
+	auto ref(cc_class::make("reference"));
+	auto ref_ctor(ref->make_constructor());
+	ref_ctor->add_arg(name_ + "&", "owner");
+	ref_ctor->add_arg("std::size_t", "index");
+	ref_ctor->add(init("owner_", "owner"));
+	ref_ctor->add(init("index_", "index"));
+	ref_ctor->define(cc_block::make());
+	ref->vpublic()->add(ref_ctor);
+	for (auto const& col: cols) {
+		auto get(ref->vpublic()->add(cc_method::make(col.type + "&", col.name)));
+		get->make_const();
+		get->define(cc_block::make())->src() << "return owner_." << col.storage << "[index_];\n";
+	}
+	ref->vprivate()->add(cc_member::make(name_ + "&", "owner_"));
+	ref->vprivate()->add(cc_member::make("std::size_t", "index_"));
+	pub->add(ref);
+
+	auto ctor(soa->make_constructor());
+	ctor->add(init("size_", "0"));
+	ctor->add(init("capacity_", "0"));
+	for (auto const& col: cols) {
+		ctor->add(init(col.storage, "nullptr"));
+	}
+	ctor->define(cc_block::make());
+	pub->add(ctor);
+
+	auto copy(soa->make_constructor());
+	copy->add_arg(name_ + " const&");
+	copy->make_delete();
+	pub->add(copy);
+	auto assign(pub->add(cc_method::make(name_ + "&", "operator=")));
+	assign->add_arg(name_ + " const&");
+	assign->make_delete();
+
+	auto dtor(soa->make_destructor());
+	auto & release(dtor->define(cc_block::make())->src());
+	for (auto const& col: cols) {
+		release << "std::free(" << col.storage << ");\n";
+	}
+	pub->add(dtor);
+
+	auto size(pub->add(cc_method::make("std::size_t", "size")));
+	size->make_const();
+	size->define(cc_block::make())->src() << "return size_;\n";
+
+	auto capacity(pub->add(cc_method::make("std::size_t", "capacity")));
+	capacity->make_const();
+	capacity->define(cc_block::make())->src() << "return capacity_;\n";
+
+	auto at(pub->add(cc_method::make("reference", "operator[]")));
+	at->add_arg("std::size_t", "index");
+	at->define(cc_block::make())->src() << "return reference(*this, index);\n";
+
+	for (auto const& col: cols) {
+		auto get(pub->add(cc_method::make(col.type + "*", col.name)));
+		get->define(cc_block::make())->src() << "return " << col.storage << ";\n";
+		auto get_const(pub->add(cc_method::make(col.type + " const*", col.name)));
+		get_const->make_const();
+		get_const->define(cc_block::make())->src() << "return " << col.storage << ";\n";
+	}
+
+	auto reserve(pub->add(cc_method::make("void", "reserve")));
+	reserve->add_arg("std::size_t", "count");
+	auto & grow(reserve->define(cc_block::make())->src());
+	grow
+		<< "if (count <= capacity_) {\n"
+		<< "\treturn;\n"
+		<< "}\n"
+		<< "std::size_t capacity(count > 2 * capacity_ ? count : 2 * capacity_);\n";
+	for (auto const& col: cols) {
+		grow
+			<< "{\n"
+			<< "\tauto column(static_cast<" << col.type << "*>(allocate(capacity * sizeof("
+			<< col.type << "))));\n"
+			<< "\tif (size_ != 0) {\n"
+			<< "\t\tstd::memcpy(column, " << col.storage << ", size_ * sizeof(" << col.type << "));\n"
+			<< "\t}\n"
+			<< "\tstd::free(" << col.storage << ");\n"
+			<< "\t" << col.storage << " = column;\n"
+			<< "}\n";
+	}
+	grow << "capacity_ = capacity;\n";
+
+	auto resize(pub->add(cc_method::make("void", "resize")));
+	resize->add_arg("std::size_t", "count");
+	auto & fill(resize->define(cc_block::make())->src());
+	fill
+		<< "reserve(count);\n"
+		<< "for (std::size_t i(size_); i < count; ++i) {\n";
+	for (auto const& col: cols) {
+		fill << "\t" << col.storage << "[i] = " << col.type << "();\n";
+	}
+	fill
+		<< "}\n"
+		<< "size_ = count;\n";
+
+	// by value, reserve() may release the rows the arguments refer to
+	auto push(pub->add(cc_method::make("void", "push_back")));
+	auto & append(push->define(cc_block::make())->src());
+	append << "reserve(size_ + 1);\n";
+	for (auto const& col: cols) {
+		push->add_arg(col.type, col.name);
+		append << col.storage << "[size_] = " << col.name << ";\n";
+	}
+	append << "++size_;\n";
+
+	// a row can be appended as a whole if its members are accessible
+	if (class_->vprotected()->members().empty() && class_->vprivate()->members().empty()) {
+		auto push_row(pub->add(cc_method::make("void", "push_back")));
+		push_row->add_arg(class_->name() + " const&", "value");
+		auto & row(push_row->define(cc_block::make())->src());
+		row << "push_back(";
+		std::string sep;
+		for (auto const& col: cols) {
+			row << sep << "value." << col.member;
+			sep = ", ";
+		}
+		row << ");\n";
+	}
+
+	auto erase(pub->add(cc_method::make("void", "erase_swap")));
+	erase->add_arg("std::size_t", "index");
+	auto & swap(erase->define(cc_block::make())->src());
+	swap << "--size_;\n";
+	for (auto const& col: cols) {
+		swap << col.storage << "[index] = " << col.storage << "[size_];\n";
+	}
+
+	auto allocate(priv->add(cc_method::make("void*", "allocate")));
+	allocate->make_static();
+	allocate->add_arg("std::size_t", "bytes");
+	allocate->define(cc_block::make())->src()
+		<< "void * res(nullptr);\n"
+		<< "bytes = (bytes + " << align_ - 1 << ") / " << align_ << " * " << align_ << ";\n"
+		<< "if (bytes != 0 && ::posix_memalign(&res, " << align_ << ", bytes) != 0) {\n"
+		<< "\tthrow std::bad_alloc();\n"
+		<< "}\n"
+		<< "return res;\n";
+
+	std::string asserts;
+	for (auto const& col: cols) {
+		asserts += "static_assert(std::is_trivially_copyable<" + col.type
+			+ ">::value, \"" + col.member + " has to be trivially copyable\");\n";
+	}
+	priv->add(raw::make(asserts + "\n"));
+
+	priv->add(cc_member::make("std::size_t", "size_"));
+	priv->add(cc_member::make("std::size_t", "capacity_"));
+	for (auto const& col: cols) {
+		priv->add(cc_member::make(col.type + "*", col.storage));
+	}
+
+	return soa;
+}
+
+}
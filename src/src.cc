@@ -27,6 +27,16 @@
 
 namespace lccc {
 
+bool src::hash(hasher &) const
+{
+	return false;
+}
+
+bool src::write(snapshot_writer &) const
+{
+	return false;
+}
+
 src::~src()
 { }
 
@@ -0,0 +1,235 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/tags.h>
+
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+bool takes(lccc::cc_method_base const& method, std::string const& type)
+{
+	return method.arguments().size() == 1 && method.arguments()[0].type == type;
+}
+
+}
+
+namespace lccc {
+
+cc_tags::ptr_t cc_tags::make(cc_class::ptr_t const& root)
+{
+	return ptr_t(new cc_tags(root));
+}
+
+cc_tags::cc_tags(cc_class::ptr_t const& root)
+:
+	root_(root),
+	copyable_(false)
+{ }
+
+void cc_tags::add(cc_class::ptr_t const& cls)
+{
+	classes_.push_back(cls);
+}
+
+void cc_tags::make_copyable()
+{
+	copyable_ = true;
+}
+
+std::string cc_tags::tag(cc_class const& cls) const
+{
+	return root_->name() + "_tag::" + cls.name();
+}
+
+std::vector<cc_tags::entry> cc_tags::order() const
+{
+	// parent of each class by index, the root has none
+	std::vector<std::size_t> parent;
+	for (auto const& cls: classes_) {
+		std::size_t found(0);
+		std::size_t count(0);
+		for (auto const& base: cls->bases()) {
+			if (base->name() == root_->name()) {
+				found = 0;
+				++count;
+			}
+			for (std::size_t i(0); i < parent.size(); ++i) {
+				if (base->name() == classes_[i]->name()) {
+					found = i + 1;
+					++count;
+				}
+			}
+		}
+		if (count != 1) {
+			throw std::invalid_argument("lccc: " + cls->name()
+				+ " needs exactly one base class in the hierarchy of " + root_->name());
+		}
+		parent.push_back(found);
+	}
+
+	std::vector<entry> res;
+	std::vector<std::size_t> position(classes_.size() + 1);
+	std::function<void(std::size_t)> walk = [&](std::size_t node) {
+		position[node] = res.size();
+		res.push_back(entry{node == 0 ? root_ : classes_[node - 1], 0});
+		for (std::size_t i(0); i < parent.size(); ++i) {
+			if (parent[i] == node) {
+				walk(i + 1);
+			}
+		}
+		res[position[node]].last = res.size() - 1;
+	};
+	walk(0);
+	return res;
+}
+
+cc_enum::ptr_t cc_tags::tags() const
+{
+	auto classes(order());
+	auto type(classes.size() <= 0x100 ? "std::uint8_t"
+		: classes.size() <= 0x10000 ? "std::uint16_t" : "std::uint32_t");
+	auto res(cc_enum::make(root_->name() + "_tag", type));
+	res->make_scoped();
+	for (auto const& e: classes) {
+		res->add(e.cls->name());
+	}
+	return res;
+}
+
+void cc_tags::apply() const
+{
+	auto classes(order());
+	auto type(root_->name() + "_tag");
+	for (auto const& e: classes) {
+		auto const& cls(e.cls);
+		auto set("tag_ = " + tag(*cls) + ";\n");
+		auto copy(cls->name() + " const&");
+		auto move(cls->name() + "&&");
+		bool copy_ctor(false);
+		bool move_ctor(false);
+		bool copy_assign(false);
+		bool move_assign(false);
+		auto ctors(cls->constructors());
+		if (ctors.empty()) {
+			auto ctor(cls->vpublic()->add(cls->make_constructor()));
+			ctor->define(cc_block::make())->src() << set;
+		}
+		for (auto const& ctor: ctors) {
+			copy_ctor |= takes(*ctor, copy);
+			move_ctor |= takes(*ctor, move);
+			if (ctor->is_deleted()) {
+				continue;
+			}
+			// copies and moves set the tag as well, the source may be
+			// a derived object
+			if (ctor->is_default() || !ctor->body()) {
+				throw std::invalid_argument("lccc: cannot tag a constructor of " + cls->name()
+					+ " without a body");
+			}
+			ctor->body()->prepend(set);
+		}
+		for (auto const& method: cls->methods()) {
+			if (method->name() != "operator=") {
+				continue;
+			}
+			copy_assign |= takes(*method, copy);
+			move_assign |= takes(*method, move);
+			// user assignments do not know tag_ and keep it
+			if (cls == root_ && method->is_default()) {
+				throw std::invalid_argument("lccc: cannot keep the tag in a defaulted assignment of "
+					+ cls->name());
+			}
+		}
+
+		// the implicit ones would copy the tag of the source, the root's
+		// assignments are made before tag_ is added and leave it alone
+		if (!copy_ctor && !move_ctor && !copy_assign && !move_assign) {
+			if (copyable_) {
+				cls->vpublic()->add(cls->make_copy_constructor())->body()->prepend(set);
+			}
+			cls->vpublic()->add(cls->make_move_constructor())->body()->prepend(set);
+			if (copyable_) {
+				cls->vpublic()->add(cls->make_copy_assignment());
+			}
+			cls->vpublic()->add(cls->make_move_assignment());
+		} else if (!copy_ctor && !move_ctor && !move_assign) {
+			throw std::invalid_argument("lccc: cannot tag the implicit copy constructor of "
+				+ cls->name());
+		} else if (cls == root_ && !copy_assign && !move_ctor && !move_assign) {
+			cls->vpublic()->add(cls->make_copy_assignment());
+		}
+
+		if (cls == root_) {
+			continue;
+		}
+		auto classof(cls->vpublic()->add(cc_method::make("bool", "classof")));
+		classof->make_static();
+		classof->make_noexcept();
+		classof->add_arg(root_->name() + " const&", "obj");
+		auto & check(classof->define(cc_block::make())->src());
+		if (e.last == std::size_t(&e - classes.data())) {
+			check << "return obj.tag() == " << tag(*cls) << ";\n";
+		} else {
+			check << "return obj.tag() >= " << tag(*cls)
+				<< " && obj.tag() <= " << tag(*classes[e.last].cls) << ";\n";
+		}
+	}
+
+	auto get(root_->vpublic()->add(cc_method::make(type, "tag")));
+	get->make_const();
+	get->make_noexcept();
+	get->define(cc_block::make())->src() << "return tag_;\n";
+	root_->vprotected()->add(cc_member::make(type, "tag_"));
+}
+
+raw::ptr_t cc_tags::visit() const
+{
+	auto classes(order());
+	std::string res;
+	for (auto qualifier: {"", " const"}) {
+		auto root(root_->name() + qualifier + "&");
+		res += "template <typename Visitor>\n"
+			"auto visit(" + root + " obj, Visitor && visitor) -> decltype(visitor(obj))\n"
+			"{\n"
+			"\tswitch (obj.tag()) {\n";
+		for (auto const& e: classes) {
+			res += "\tcase " + tag(*e.cls) + ":\n";
+			if (e.cls != root_) {
+				res += "\t\treturn visitor(static_cast<" + e.cls->name() + qualifier + "&>(obj));\n";
+			} else {
+				res += "\t\tbreak;\n";
+			}
+		}
+		res += "\t}\n"
+			"\treturn visitor(obj);\n"
+			"}\n"
+			"\n";
+	}
+	return raw::make(res);
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+   Copyright (c) 2014, Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <lccc/base.h>
+
+#include <cstring>
+#include <ostream>
+
+namespace lccc {
+
+text_ref::text_ref(char const* str)
+:
+	data_(str),
+	size_(std::strlen(str))
+{ }
+
+text_ref::text_ref(char const* data, std::size_t size)
+:
+	data_(data),
+	size_(size)
+{ }
+
+text_ref::text_ref(std::string const& str)
+:
+	data_(str.data()),
+	size_(str.size())
+{ }
+
+char const* text_ref::data() const
+{
+	return data_;
+}
+
+std::size_t text_ref::size() const
+{
+	return size_;
+}
+
+bool text_ref::empty() const
+{
+	return size_ == 0;
+}
+
+std::string text_ref::str() const
+{
+	return std::string(data_, size_);
+}
+
+bool operator==(text_ref const& l, text_ref const& r)
+{
+	return l.size() == r.size() && (l.size() == 0 || std::memcmp(l.data(), r.data(), l.size()) == 0);
+}
+
+bool operator!=(text_ref const& l, text_ref const& r)
+{
+	return !(l == r);
+}
+
+std::ostream & operator<<(std::ostream & os, text_ref const& str)
+{
+	return os.write(str.data(), str.size());
+}
+
+}
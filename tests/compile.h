@@ -0,0 +1,42 @@
+#ifndef UNITTESTS_COMPILE_H
+#define UNITTESTS_COMPILE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+
+#ifndef LCCC_TEST_CXX
+#define LCCC_TEST_CXX "c++"
+#endif
+
+namespace unittests {
+
+// compiles and runs a program, which has to exit with 0
+inline void compile_and_run(std::string const& program)
+{
+	char dir[] = "/tmp/lccc-compile-XXXXXX";
+	CPPUNIT_ASSERT(::mkdtemp(dir) != nullptr);
+	std::string source(std::string(dir) + "/test.cc");
+	std::string binary(std::string(dir) + "/test");
+	{
+		std::ofstream out(source);
+		out << program;
+	}
+
+	std::string compile(LCCC_TEST_CXX " -std=c++11 -Wall -Wextra -Werror -o "
+		+ binary + " " + source);
+	int compiled(std::system(compile.c_str()));
+	int ran(compiled == 0 ? std::system(binary.c_str()) : -1);
+	std::remove(source.c_str());
+	std::remove(binary.c_str());
+	::rmdir(dir);
+	CPPUNIT_ASSERT_EQUAL(0, compiled);
+	CPPUNIT_ASSERT_EQUAL(0, ran);
+}
+
+}
+
+#endif
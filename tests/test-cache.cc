@@ -0,0 +1,347 @@
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <lccc/cache.h>
+#include <lccc/cc.h>
+#include <lccc/hash.h>
+
+namespace unittests {
+namespace cache {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_hash();
+	void test_cached_output();
+	void test_stats();
+	void test_detach();
+	void test_disk_cache();
+	void test_disk_cache_eviction();
+	void test_disk_cache_min_size();
+	void test_disk_cache_version();
+	void test_hash_once();
+	void test_collision();
+
+	std::string dir_;
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_hash);
+	CPPUNIT_TEST(test_cached_output);
+	CPPUNIT_TEST(test_stats);
+	CPPUNIT_TEST(test_detach);
+	CPPUNIT_TEST(test_disk_cache);
+	CPPUNIT_TEST(test_disk_cache_eviction);
+	CPPUNIT_TEST(test_disk_cache_min_size);
+	CPPUNIT_TEST(test_disk_cache_version);
+	CPPUNIT_TEST(test_hash_once);
+	CPPUNIT_TEST(test_collision);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{
+	char dir[] = "/tmp/lccc-test-XXXXXX";
+	dir_ = ::mkdtemp(dir);
+}
+
+void test::tearDown()
+{
+	auto dir(::opendir(dir_.c_str()));
+	while (auto ent = ::readdir(dir)) {
+		std::remove((dir_ + "/" + ent->d_name).c_str());
+	}
+	::closedir(dir);
+	::rmdir(dir_.c_str());
+}
+
+namespace {
+
+lccc::cc_class::ptr_t make_class(std::string const& name)
+{
+	auto cls(lccc::cc_class::make(name));
+	auto dtor(cls->make_destructor());
+	dtor->make_virtual();
+	cls->vpublic()->add(dtor);
+	auto get(lccc::cc_method::make("int", "get"));
+	get->make_const();
+	cls->vpublic()->add(get);
+	cls->vprivate()->add(lccc::cc_member::make("int", "value_"));
+	return cls;
+}
+
+// a leaf counting how often it is hashed, large enough for its digest
+// to be kept
+class counted : public lccc::src {
+public:
+	counted()
+	:
+		count(0)
+	{ }
+
+	std::ostream & print(std::ostream & os) const
+	{
+		return os << "leaf\n";
+	}
+
+	bool hash(lccc::hasher & h) const
+	{
+		++count;
+		h.add(std::string(1024, 'x'));
+		return true;
+	}
+
+	mutable std::size_t count;
+};
+
+lccc::cc_namespace::ptr_t make_tree()
+{
+	auto ns(lccc::cc_namespace::make("foo"));
+	ns->add(make_class("bar"));
+	ns->add(make_class("baz"));
+	return ns;
+}
+
+}
+
+void test::test_hash()
+{
+	lccc::hasher h1;
+	lccc::hasher h2;
+	CPPUNIT_ASSERT(h1.add(*make_tree()));
+	CPPUNIT_ASSERT(h2.add(*make_tree()));
+	CPPUNIT_ASSERT_EQUAL(h1.value(), h2.value());
+
+	lccc::hasher h3;
+	auto ns(make_tree());
+	ns->add(lccc::cc_member::make("int", "x"));
+	CPPUNIT_ASSERT(h3.add(*ns));
+	CPPUNIT_ASSERT(h1.value() != h3.value());
+
+	lccc::hasher h4;
+	lccc::hasher h5;
+	h4.add(*lccc::cc_member::make("int", "x"));
+	h5.add(*lccc::cc_member::make("in", "tx"));
+	CPPUNIT_ASSERT(h4.value() != h5.value());
+}
+
+void test::test_cached_output()
+{
+	auto ns(make_tree());
+	std::stringstream expected;
+	ns->print(expected);
+
+	auto cache(lccc::render_cache::make());
+	std::stringstream out;
+	cache->attach(out);
+	ns->print(out);
+	cache->detach(out);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+
+	std::stringstream again;
+	cache->attach(again);
+	ns->print(again);
+	cache->detach(again);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), again.str());
+}
+
+void test::test_stats()
+{
+	auto ns(make_tree());
+	auto cache(lccc::render_cache::make());
+	std::stringstream out;
+	cache->attach(out);
+	ns->print(out);
+	cache->detach(out);
+
+	// the destructors differ by class name, the getter and the
+	// protected and private sections are rendered only once
+	auto stats(cache->statistics());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(3), stats.hits);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(10), stats.misses);
+	std::string get("int get() const;\n\n");
+	std::string priv(
+		"private:\n"
+		"\tint value_;\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(get.size() + priv.size(), stats.bytes_saved);
+	CPPUNIT_ASSERT(stats.hit_rate() > 0.0);
+
+	cache->clear();
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache->statistics().hits);
+}
+
+void test::test_detach()
+{
+	auto cache(lccc::render_cache::make());
+	std::stringstream out;
+	cache->attach(out);
+	cache->detach(out);
+	make_tree()->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache->statistics().misses);
+}
+
+void test::test_disk_cache()
+{
+	auto ns(make_tree());
+	std::stringstream expected;
+	ns->print(expected);
+
+	{
+		auto cache(lccc::render_cache::make(lccc::disk_cache::make(dir_, 1 << 20, 0)));
+		std::stringstream out;
+		cache->attach(out);
+		ns->print(out);
+		CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+		CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache->statistics().disk_hits);
+	}
+
+	// a new run with one class changed renders only that class
+	ns = lccc::cc_namespace::make("foo");
+	auto bar(make_class("bar"));
+	bar->vpublic()->add(lccc::cc_method::make("void", "set"));
+	ns->add(bar);
+	ns->add(make_class("baz"));
+	expected.str("");
+	ns->print(expected);
+
+	auto disk(lccc::disk_cache::make(dir_, 1 << 20, 0));
+	CPPUNIT_ASSERT(disk->size() > 0);
+	auto cache(lccc::render_cache::make(disk));
+	std::stringstream out;
+	cache->attach(out);
+	ns->print(out);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+
+	// baz and the unchanged sections and methods of bar are read from disk
+	auto stats(cache->statistics());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(5), stats.disk_hits);
+}
+
+void test::test_disk_cache_eviction()
+{
+	auto disk(lccc::disk_cache::make(dir_, 10, 0));
+	disk->store(1, "0123");
+	disk->store(2, "4567");
+	std::string frag;
+	CPPUNIT_ASSERT(disk->load(1, frag));
+	CPPUNIT_ASSERT_EQUAL(std::string("0123"), frag);
+	disk->store(3, "89ab");
+	CPPUNIT_ASSERT_EQUAL(std::size_t(8), disk->size());
+	CPPUNIT_ASSERT(!disk->load(2, frag));
+	CPPUNIT_ASSERT(disk->load(3, frag));
+	CPPUNIT_ASSERT_EQUAL(std::string("89ab"), frag);
+
+	disk->store(4, "too large for the cache");
+	CPPUNIT_ASSERT(!disk->load(4, frag));
+
+	auto reopened(lccc::disk_cache::make(dir_, 10, 0));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(8), reopened->size());
+	CPPUNIT_ASSERT(reopened->load(1, frag));
+	CPPUNIT_ASSERT_EQUAL(std::string("0123"), frag);
+}
+
+void test::test_disk_cache_min_size()
+{
+	auto disk(lccc::disk_cache::make(dir_, 1 << 20));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(4096), disk->min_size());
+	auto cache(lccc::render_cache::make(disk));
+	std::stringstream out;
+	cache->attach(out);
+	make_tree()->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), disk->size());
+
+	auto ns(lccc::cc_namespace::make("large"));
+	for (std::size_t i(0); i < 100; ++i) {
+		ns->add(make_class("large" + std::to_string(i)));
+	}
+	cache->print(*ns, out);
+	CPPUNIT_ASSERT(disk->size() >= 4096);
+
+	std::string frag;
+	disk->store(1, "small");
+	CPPUNIT_ASSERT(!disk->load(1, frag));
+}
+
+void test::test_disk_cache_version()
+{
+	auto ns(make_tree());
+	std::stringstream expected;
+	ns->print(expected);
+
+	// a fragment keyed without the version, as if from an older release
+	lccc::hasher h;
+	CPPUNIT_ASSERT(h.add(*ns));
+	auto disk(lccc::disk_cache::make(dir_, 1 << 20, 0));
+	disk->store(h.value(), "stale");
+
+	auto cache(lccc::render_cache::make(disk));
+	std::stringstream out;
+	cache->print(*ns, out);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache->statistics().disk_hits);
+
+	// no temporary files are left behind
+	auto dir(::opendir(dir_.c_str()));
+	while (auto ent = ::readdir(dir)) {
+		std::string name(ent->d_name);
+		CPPUNIT_ASSERT(name[0] == '.' || name.size() == 16);
+	}
+	::closedir(dir);
+}
+
+void test::test_hash_once()
+{
+	auto leaf(std::make_shared<counted>());
+	lccc::src::ptr_t node(leaf);
+	for (auto name: {"a", "b", "c", "d"}) {
+		auto ns(lccc::cc_namespace::make(name));
+		ns->add(node);
+		node = ns;
+	}
+
+	auto cache(lccc::render_cache::make());
+	std::stringstream out;
+	cache->attach(out);
+	node->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), leaf->count);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(4), cache->statistics().misses);
+
+	// the digests do not outlive the print
+	node->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(2), leaf->count);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache->statistics().hits);
+}
+
+void test::test_collision()
+{
+	auto ns(make_tree());
+	std::stringstream expected;
+	ns->print(expected);
+
+	// another fragment under the same key, with a check that does not match
+	lccc::hasher h;
+	h.add(lccc::render_cache::version);
+	CPPUNIT_ASSERT(h.add(*ns));
+	auto disk(lccc::disk_cache::make(dir_, 1 << 20, 0));
+	disk->store(h.value(), std::string(8, '\0') + "namespace other {\n}\n");
+
+	auto cache(lccc::render_cache::make(disk));
+	std::stringstream out;
+	cache->print(*ns, out);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache->statistics().disk_hits);
+}
+
+}}
@@ -1,6 +1,10 @@
+#include <cstdint>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <cppunit/extensions/HelperMacros.h>
 #include <lccc/cc.h>
+#include "compile.h"
 
 namespace unittests {
 namespace cc {
@@ -29,6 +33,31 @@ private:
 	void test_destructor();
 	void test_virtual_destructor();
 	void test_member();
+	void test_lazy();
+	void test_lazy_visibility();
+	void test_array();
+	void test_array_hex();
+	void test_array_limits();
+	void test_array_limits_compile();
+	void test_array_float();
+	void test_array_visibility();
+	void test_enum();
+	void test_enum_sparse();
+	void test_layout();
+	void test_layout_compile();
+	void test_pack();
+	void test_pack_compile();
+	void test_method_qualifiers();
+	void test_special_qualifiers();
+	void test_qualifiers_compile();
+	void test_default_delete();
+	void test_move_compile();
+	void test_pool_compile();
+	void test_serialize();
+	void test_serialize_compile();
+	void test_hashable();
+	void test_hashable_compile();
+	void test_reflect_compile();
 
 	CPPUNIT_TEST_SUITE(test);
 	CPPUNIT_TEST(test_namespace);
@@ -48,6 +77,31 @@ private:
 	CPPUNIT_TEST(test_destructor);
 	CPPUNIT_TEST(test_virtual_destructor);
 	CPPUNIT_TEST(test_member);
+	CPPUNIT_TEST(test_lazy);
+	CPPUNIT_TEST(test_lazy_visibility);
+	CPPUNIT_TEST(test_array);
+	CPPUNIT_TEST(test_array_hex);
+	CPPUNIT_TEST(test_array_limits);
+	CPPUNIT_TEST(test_array_limits_compile);
+	CPPUNIT_TEST(test_array_float);
+	CPPUNIT_TEST(test_array_visibility);
+	CPPUNIT_TEST(test_enum);
+	CPPUNIT_TEST(test_enum_sparse);
+	CPPUNIT_TEST(test_layout);
+	CPPUNIT_TEST(test_layout_compile);
+	CPPUNIT_TEST(test_pack);
+	CPPUNIT_TEST(test_pack_compile);
+	CPPUNIT_TEST(test_method_qualifiers);
+	CPPUNIT_TEST(test_special_qualifiers);
+	CPPUNIT_TEST(test_qualifiers_compile);
+	CPPUNIT_TEST(test_default_delete);
+	CPPUNIT_TEST(test_move_compile);
+	CPPUNIT_TEST(test_pool_compile);
+	CPPUNIT_TEST(test_serialize);
+	CPPUNIT_TEST(test_serialize_compile);
+	CPPUNIT_TEST(test_hashable);
+	CPPUNIT_TEST(test_hashable_compile);
+	CPPUNIT_TEST(test_reflect_compile);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -340,6 +394,1103 @@ void test::test_member()
 	src->print(out);
 	std::string expected("void * bar_;\n");
 	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+	CPPUNIT_ASSERT(!src->is_static());
+	CPPUNIT_ASSERT(lccc::cc_member::make("static int", "count")->is_static());
+	CPPUNIT_ASSERT(!lccc::cc_member::make("staticky", "s")->is_static());
+}
+
+void test::test_lazy()
+{
+	std::size_t produced(0);
+	std::weak_ptr<lccc::src> last;
+	auto ns(lccc::cc_namespace::make("foo"));
+	ns->add(lccc::lazy::make([&](lccc::lazy::emit_t const& emit) {
+		for (auto name: {"bar", "baz"}) {
+			auto node(lccc::cc_namespace::make(name));
+			last = node;
+			emit(node);
+			++produced;
+		}
+	}));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(0), produced);
+
+	std::stringstream out;
+	ns->print(out);
+	std::string expected(
+		"namespace foo {\n"
+		"namespace bar {\n"
+		"}\n"
+		"namespace baz {\n"
+		"}\n"
+		"}\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(2), produced);
+	CPPUNIT_ASSERT(last.expired());
+}
+
+void test::test_lazy_visibility()
+{
+	auto src(lccc::cc_class::make("foo"));
+	src->vprivate()->add(lccc::lazy::make([](lccc::lazy::emit_t const& emit) {
+		for (auto name: {"a_", "b_"}) {
+			emit(lccc::cc_member::make("int", name));
+		}
+	}));
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo {\n"
+		"private:\n"
+		"\tint a_;\n"
+		"\tint b_;\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_array()
+{
+	std::uint16_t data[] = {0, 7, 42, 65535, 1000};
+	auto src(lccc::cc_array::make("uint16_t", "table", data, 5));
+	src->make_static();
+	src->make_constexpr();
+	src->align(64);
+	src->wrap(16);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"alignas(64) static constexpr uint16_t table[5] = {\n"
+		"\t0, 7, 42, 65535,\n"
+		"\t1000,\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+	CPPUNIT_ASSERT(src->data() == data);
+
+	CPPUNIT_ASSERT_THROW(lccc::cc_array::make("uint16_t", "none", data, 0), std::invalid_argument);
+	CPPUNIT_ASSERT_THROW(lccc::cc_array::make("int", "none", std::vector<int>()),
+		std::invalid_argument);
+}
+
+void test::test_array_hex()
+{
+	std::vector<std::uint8_t> data;
+	for (unsigned i(0); i < 10; ++i) {
+		data.push_back(i * 31);
+	}
+	auto src(lccc::cc_array::make("std::uint8_t", "blob", data));
+	src->make_hex();
+	src->wrap(30);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"std::uint8_t blob[10] = {\n"
+		"\t0x00, 0x1f, 0x3e, 0x5d, 0x7c,\n"
+		"\t0x9b, 0xba, 0xd9, 0xf8, 0x17,\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_array_limits()
+{
+	std::vector<std::int64_t> sdata{
+		std::numeric_limits<std::int64_t>::min(),
+		std::numeric_limits<std::int64_t>::max(),
+		-1,
+	};
+	std::vector<std::int8_t> bdata{-128, 127, -1};
+	std::vector<std::uint64_t> udata{std::numeric_limits<std::uint64_t>::max()};
+
+	std::stringstream out;
+	lccc::cc_array::make("int64_t", "s", sdata)->print(out);
+	lccc::cc_array::make("int8_t", "b", bdata)->print(out);
+	lccc::cc_array::make("uint64_t", "u", udata)->print(out);
+	auto hex(lccc::cc_array::make("int8_t", "h", bdata));
+	hex->make_hex();
+	hex->print(out);
+	std::string expected(
+		"int64_t s[3] = {\n"
+		"\t(-9223372036854775807 - 1), 9223372036854775807, -1,\n"
+		"};\n"
+		"int8_t b[3] = {\n"
+		"\t-128, 127, -1,\n"
+		"};\n"
+		"uint64_t u[1] = {\n"
+		"\t18446744073709551615u,\n"
+		"};\n"
+		"int8_t h[3] = {\n"
+		"\t-0x80, 0x7f, -0x01,\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_array_limits_compile()
+{
+	std::vector<std::int32_t> words{std::numeric_limits<std::int32_t>::min(), -1,
+		std::numeric_limits<std::int32_t>::max()};
+	std::vector<std::int64_t> longs{std::numeric_limits<std::int64_t>::min(), -1,
+		std::numeric_limits<std::int64_t>::max()};
+	std::vector<std::int16_t> shorts{std::numeric_limits<std::int16_t>::min(), -1};
+
+	std::ostringstream code;
+	code << "#include <cstdint>\n#include <limits>\n";
+	for (auto hex: {false, true}) {
+		std::string suffix(hex ? "_hex" : "");
+		auto w(lccc::cc_array::make("std::int32_t", "words" + suffix, words));
+		auto l(lccc::cc_array::make("std::int64_t", "longs" + suffix, longs));
+		auto s(lccc::cc_array::make("std::int16_t", "shorts" + suffix, shorts));
+		for (auto array: {w, l, s}) {
+			if (hex) {
+				array->make_hex();
+			}
+			array->make_constexpr();
+			array->print(code);
+		}
+	}
+	code << R"(
+template <typename T>
+constexpr bool limits(T const* a)
+{
+	return a[0] == std::numeric_limits<T>::min() && a[1] == -1;
+}
+
+static_assert(limits(words) && limits(words_hex), "int32 minimum");
+static_assert(limits(longs) && limits(longs_hex), "int64 minimum");
+static_assert(limits(shorts) && limits(shorts_hex), "int16 minimum");
+
+int main()
+{
+	return words_hex[2] == std::numeric_limits<std::int32_t>::max()
+		&& longs_hex[2] == std::numeric_limits<std::int64_t>::max() ? 0 : 1;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_array_float()
+{
+	std::vector<float> fdata{1.0f, 0.5f, -2.25f, 1e20f};
+	std::vector<double> ddata{0.1, std::numeric_limits<double>::infinity()};
+
+	std::stringstream out;
+	lccc::cc_array::make("float", "f", fdata)->print(out);
+	lccc::cc_array::make("double", "d", ddata)->print(out);
+	std::string expected(
+		"float f[4] = {\n"
+		"\t1.0f, 0.5f, -2.25f, 1.00000002e+20f,\n"
+		"};\n"
+		"double d[2] = {\n"
+		"\t0.10000000000000001, std::numeric_limits<double>::infinity(),\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_array_visibility()
+{
+	int data[] = {1, 2, 3};
+	auto src(lccc::cc_class::make("foo"));
+	auto table(src->vprivate()->add(lccc::cc_array::make("int", "table_", data, 3)));
+	table->make_static();
+	table->make_constexpr();
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo {\n"
+		"private:\n"
+		"\tstatic constexpr int table_[3] = {\n"
+		"\t\t1, 2, 3,\n"
+		"\t};\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_enum()
+{
+	auto src(lccc::cc_enum::make("color", "int"));
+	src->make_scoped();
+	src->add("red");
+	src->add("green");
+	src->add("blue", 3);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"enum class color : int {\n"
+		"\tred,\n"
+		"\tgreen,\n"
+		"\tblue = 3,\n"
+		"};\n"
+		"\n"
+		"inline char const* to_string(color value)\n"
+		"{\n"
+		"\tstatic constexpr char const* names[4] = {\n"
+		"\t\t\"red\",\n"
+		"\t\t\"green\",\n"
+		"\t\t\"\",\n"
+		"\t\t\"blue\",\n"
+		"\t};\n"
+		"\tstd::uint64_t index(static_cast<std::uint64_t>(value));\n"
+		"\treturn index < 4 ? names[index] : \"\";\n"
+		"}\n"
+		"\n"
+		"inline bool from_string(char const* key, std::size_t size, color& value)\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str().substr(0, expected.size()));
+	CPPUNIT_ASSERT_THROW(src->add("red"), std::invalid_argument);
+
+	// the lookup kept from the first print is searched again
+	CPPUNIT_ASSERT(out.str().find("color::black") == std::string::npos);
+	src->add("black");
+	std::stringstream again;
+	src->print(again);
+	CPPUNIT_ASSERT(again.str().find("color::black") != std::string::npos);
+
+	auto last(lccc::cc_enum::make("last"));
+	last->add("max", std::numeric_limits<std::int64_t>::max());
+	CPPUNIT_ASSERT_THROW(last->add("next"), std::invalid_argument);
+}
+
+void test::test_enum_sparse()
+{
+	auto src(lccc::cc_enum::make("code"));
+	src->add("b", 1000);
+	src->add("a", -7);
+	auto cls(lccc::cc_class::make("foo"));
+	cls->vpublic()->add(src);
+
+	std::stringstream out;
+	cls->print(out);
+	std::string expected(
+		"class foo {\n"
+		"public:\n"
+		"\tenum code {\n"
+		"\t\tb = 1000,\n"
+		"\t\ta = -7,\n"
+		"\t};\n"
+		"\n"
+		"\tstatic char const* to_string(code value)\n"
+		"\t{\n"
+		"\t\tstruct entry {\n"
+		"\t\t\tstd::int64_t value;\n"
+		"\t\t\tchar const* name;\n"
+		"\t\t};\n"
+		"\t\tstatic constexpr entry names[2] = {\n"
+		"\t\t\t{-7, \"a\"},\n"
+		"\t\t\t{1000, \"b\"},\n"
+		"\t\t};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str().substr(0, expected.size()));
+	CPPUNIT_ASSERT(out.str().find("\tstatic bool from_string(char const* key, std::size_t size, code& value)\n")
+		!= std::string::npos);
+}
+
+void test::test_layout()
+{
+	auto src(lccc::cc_class::make("foo"));
+	src->vpublic()->add(lccc::cc_member::make("char", "a"));
+	src->vpublic()->add(lccc::cc_method::make("void", "run"));
+	src->vpublic()->add(lccc::cc_member::make("double", "b"));
+	src->vpublic()->add(lccc::cc_member::make("short", "c"));
+	src->vpublic()->add(lccc::cc_member::make("static std::string", "names"));
+	src->vpublic()->add(lccc::cc_member::make("int*", "d"))->make_cold();
+	src->vpublic()->add(lccc::cc_member::make("bool", "e"))->make_hot();
+
+	auto before(src->estimate());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(40), before.size);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(8), before.alignment);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(20), before.padding);
+
+	auto after(src->layout());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(32), after.size);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(12), after.padding);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo {\n"
+		"public:\n"
+		"\tbool e;\n"
+		"\tvoid run();\n"
+		"\n"
+		"\tdouble b;\n"
+		"\tshort c;\n"
+		"\tstatic std::string names;\n"
+		"\tchar a;\n"
+		"\tint* d;\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+
+	src->vprivate()->add(lccc::cc_member::make("std::string", "name"));
+	CPPUNIT_ASSERT_THROW(src->estimate(), std::invalid_argument);
+}
+
+void test::test_layout_compile()
+{
+	auto src(lccc::cc_class::make("counters"));
+	auto dtor(src->make_destructor());
+	dtor->make_virtual();
+	dtor->define(lccc::cc_block::make());
+	src->vpublic()->add(dtor);
+	src->vpublic()->add(lccc::cc_member::make("std::uint8_t", "state"))->make_hot();
+	src->vpublic()->add(lccc::cc_member::make("std::uint64_t", "hits"))->make_hot();
+	auto shared(src->vpublic()->add(lccc::cc_member::make("std::atomic<int>", "shared")));
+	shared->layout(4, 4);
+	shared->align(64);
+	src->vprivate()->add(lccc::cc_member::make("char const*", "name"))->make_cold();
+	src->vprivate()->add(lccc::cc_member::make("std::uint16_t", "id"));
+	src->vprivate()->add(lccc::cc_member::make("float", "load"));
+	auto info(src->layout());
+
+	std::ostringstream code;
+	code << "#include <atomic>\n#include <cstdint>\n";
+	src->print(code);
+	code
+		<< "static_assert(sizeof(counters) == " << info.size << ", \"size\");\n"
+		<< "static_assert(alignof(counters) == " << info.alignment << ", \"alignment\");\n"
+		<< "int main()\n"
+		<< "{\n"
+		<< "\treturn 0;\n"
+		<< "}\n";
+	unittests::compile_and_run(code.str());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(128), info.size);
+}
+
+void test::test_pack()
+{
+	auto src(lccc::cc_class::make("foo"));
+	src->vpublic()->add(lccc::cc_member::make("int", "a"));
+	src->vpublic()->add(lccc::cc_member::make("bool", "b"));
+	src->vpublic()->add(lccc::cc_member::make("mode", "c"))->pack(3);
+	src->pack();
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo {\n"
+		"public:\n"
+		"\tint a;\n"
+		"\tstd::uint8_t public_bits0_;\n"
+		"\tbool b() const\n"
+		"\t{\n"
+		"\t\treturn static_cast<bool>((public_bits0_ >> 0) & 0x1u);\n"
+		"\t}\n"
+		"\n"
+		"\tvoid b(bool value)\n"
+		"\t{\n"
+		"\t\tpublic_bits0_ = static_cast<std::uint8_t>((public_bits0_ & ~(static_cast<std::uint8_t>(0x1u) << 0)) |\n"
+		"\t\t\t((static_cast<std::uint8_t>(value) & 0x1u) << 0));\n"
+		"\t}\n"
+		"\n"
+		"\tmode c() const\n"
+		"\t{\n"
+		"\t\treturn static_cast<mode>((public_bits0_ >> 1) & 0x7u);\n"
+		"\t}\n"
+		"\n"
+		"\tvoid c(mode value)\n"
+		"\t{\n"
+		"\t\tpublic_bits0_ = static_cast<std::uint8_t>((public_bits0_ & ~(static_cast<std::uint8_t>(0x7u) << 1)) |\n"
+		"\t\t\t((static_cast<std::uint8_t>(value) & 0x7u) << 1));\n"
+		"\t}\n"
+		"\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_pack_compile()
+{
+	auto src(lccc::cc_class::make("config"));
+	auto pub(src->vpublic());
+	pub->add(lccc::cc_member::make("std::uint32_t", "id"));
+	for (int i(0); i < 40; ++i) {
+		pub->add(lccc::cc_member::make("bool", "flag" + std::to_string(i)));
+	}
+	pub->add(lccc::cc_member::make("level", "lvl"))->pack(2);
+	pub->add(lccc::cc_member::make("std::uint32_t", "count"))->pack(30);
+	pub->add(lccc::cc_member::make("int", "delta"))->pack(5);
+	pub->add(lccc::cc_member::make("std::int8_t", "step"))->pack(4);
+	src->pack();
+	auto info(src->layout());
+
+	std::ostringstream code;
+	code
+		<< "#include <cstdint>\n"
+		<< "enum class level { low, mid, high };\n";
+	src->print(code);
+	code
+		<< "static_assert(sizeof(config) == " << info.size << ", \"size\");\n"
+		<< "int main()\n"
+		<< "{\n"
+		<< "\tconfig c;\n"
+		<< "\tc.id = 7;\n";
+	for (int i(0); i < 40; ++i) {
+		code << "\tc.flag" << i << "(" << (i % 3 == 0 ? "true" : "false") << ");\n";
+	}
+	code
+		<< "\tc.lvl(level::high);\n"
+		<< "\tc.count(0x3fffffff);\n"
+		<< "\tc.delta(-7);\n"
+		<< "\tc.step(7);\n"
+		<< "\tc.flag1(true);\n"
+		<< "\tc.flag1(false);\n"
+		<< "\tint res(c.id == 7 ? 0 : 1);\n";
+	for (int i(0); i < 40; ++i) {
+		code << "\tres |= c.flag" << i << "() == " << (i % 3 == 0 ? "true" : "false") << " ? 0 : 1;\n";
+	}
+	code
+		<< "\tres |= c.lvl() == level::high ? 0 : 1;\n"
+		<< "\tres |= c.count() == 0x3fffffff ? 0 : 1;\n"
+		<< "\tres |= c.delta() == -7 && c.step() == 7 ? 0 : 1;\n"
+		<< "\tc.delta(-16);\n"
+		<< "\tc.step(-8);\n"
+		<< "\tres |= c.delta() == -16 && c.step() == -8 ? 0 : 1;\n"
+		<< "\treturn res;\n"
+		<< "}\n";
+	unittests::compile_and_run(code.str());
+	CPPUNIT_ASSERT_EQUAL(std::size_t(16), info.size);
+}
+
+void test::test_method_qualifiers()
+{
+	auto run(lccc::cc_method::make("int", "run"));
+	run->add_attribute("nodiscard");
+	run->add_attribute("gnu::hot");
+	run->make_virtual();
+	run->make_inline();
+	run->make_const();
+	run->make_noexcept();
+	run->make_final();
+
+	auto get(lccc::cc_method::make("int", "get"));
+	get->make_static();
+	get->make_constexpr();
+	get->define(lccc::cc_block::make())->src() << "return 1;\n";
+
+	std::stringstream out;
+	run->print(out);
+	get->print(out);
+	std::string expected(
+		"[[nodiscard, gnu::hot]] virtual inline int run() const noexcept final;\n"
+		"\n"
+		"static constexpr int get()\n"
+		"{\n"
+		"\treturn 1;\n"
+		"}\n"
+		"\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_special_qualifiers()
+{
+	auto src(lccc::cc_class::make("foo"));
+	src->make_final();
+	auto ctor(src->make_constructor());
+	ctor->add_arg("int");
+	ctor->make_constexpr();
+	ctor->make_noexcept();
+	ctor->add_attribute("gnu::cold");
+	src->vpublic()->add(ctor);
+	auto dtor(src->make_destructor());
+	dtor->make_virtual();
+	dtor->make_noexcept();
+	dtor->make_final();
+	src->vpublic()->add(dtor);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo final {\n"
+		"public:\n"
+		"\t[[gnu::cold]] constexpr foo(int) noexcept;\n"
+		"\tvirtual ~foo() noexcept final;\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_qualifiers_compile()
+{
+	auto base(lccc::cc_class::make("shape"));
+	auto area(base->vpublic()->add(lccc::cc_method::make("int", "area")));
+	area->make_abstract();
+	area->make_const();
+	auto base_dtor(base->make_destructor());
+	base_dtor->make_virtual();
+	base_dtor->define(lccc::cc_block::make());
+	base->vpublic()->add(base_dtor);
+
+	auto square(lccc::cc_class::make("square"));
+	square->make_final();
+	square->add(lccc::cc_base_class::make("shape"));
+	auto ctor(square->make_constructor());
+	ctor->add_arg("int", "side");
+	ctor->make_constexpr();
+	ctor->make_noexcept();
+	ctor->add(lccc::cc_base_class::make("side_")->make_initializer("side"));
+	ctor->define(lccc::cc_block::make());
+	square->vpublic()->add(ctor);
+
+	auto side(square->vpublic()->add(lccc::cc_method::make("int", "side")));
+	side->make_constexpr();
+	side->make_const();
+	side->make_noexcept();
+	side->add_attribute("gnu::always_inline");
+	side->define(lccc::cc_block::make())->src() << "return side_;\n";
+
+	auto sq_area(square->vpublic()->add(lccc::cc_method::make("int", "area")));
+	sq_area->make_virtual();
+	sq_area->make_const();
+	sq_area->make_final();
+	sq_area->add_attribute("gnu::hot");
+	sq_area->define(lccc::cc_block::make())->src() << "return side_ * side_;\n";
+
+	auto unit(square->vpublic()->add(lccc::cc_method::make("square", "unit")));
+	unit->make_static();
+	unit->make_noexcept();
+	unit->define(lccc::cc_block::make())->src() << "return square(1);\n";
+	square->vprivate()->add(lccc::cc_member::make("int", "side_"));
+
+	std::ostringstream code;
+	base->print(code);
+	square->print(code);
+	code
+		<< "inline void test() {\n"
+		<< "\tstatic_assert(noexcept(square(2)), \"noexcept\");\n"
+		<< "\tstatic_assert(noexcept(square::unit()), \"noexcept\");\n"
+		<< "}\n"
+		<< "int main()\n"
+		<< "{\n"
+		<< "\tsquare s(3);\n"
+		<< "\tshape const& sh(s);\n"
+		<< "\treturn sh.area() == 9 && s.side() == 3 && square::unit().area() == 1 ? 0 : 1;\n"
+		<< "}\n";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_default_delete()
+{
+	auto src(lccc::cc_class::make("foo"));
+	auto ctor(src->make_constructor());
+	ctor->make_default();
+	src->vpublic()->add(ctor);
+	auto copy(src->make_constructor());
+	copy->add_arg("foo const&");
+	copy->make_delete();
+	src->vpublic()->add(copy);
+	auto assign(src->vpublic()->add(lccc::cc_method::make("foo&", "operator=")));
+	assign->add_arg("foo const&");
+	assign->make_delete();
+	auto dtor(src->make_destructor());
+	dtor->make_default();
+	dtor->define(lccc::cc_block::make());
+	src->vpublic()->add(dtor);
+
+	std::stringstream out;
+	src->print(out);
+	std::string expected(
+		"class foo {\n"
+		"public:\n"
+		"\tfoo() = default;\n"
+		"\tfoo(foo const&) = delete;\n"
+		"\tfoo& operator=(foo const&) = delete;\n"
+		"\n"
+		"\t~foo() = default;\n"
+		"};\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_move_compile()
+{
+	auto base(lccc::cc_class::make("named"));
+	base->vpublic()->add(lccc::cc_member::make("std::string", "name"));
+
+	auto src(lccc::cc_class::make("record"));
+	src->add(lccc::cc_base_class::make("named"));
+	src->vpublic()->add(lccc::cc_member::make("std::vector<int>", "values"));
+	src->vpublic()->add(lccc::cc_member::make("std::unique_ptr<int>", "extra"));
+	src->vpublic()->add(lccc::cc_member::make("int", "count"));
+	src->vpublic()->add(lccc::cc_member::make("static int", "instances"));
+
+	auto ctor(src->make_constructor());
+	ctor->make_default();
+	src->vpublic()->add(ctor);
+	src->vpublic()->add(src->make_move_constructor());
+	src->vpublic()->add(src->make_move_assignment());
+	auto copy(src->make_constructor());
+	copy->add_arg("record const&");
+	copy->make_delete();
+	src->vpublic()->add(copy);
+	auto dtor(src->make_destructor());
+	dtor->make_default();
+	src->vpublic()->add(dtor);
+
+	auto holder(lccc::cc_class::make("holder"));
+	holder->vpublic()->add(lccc::cc_member::make("thrower", "t"));
+	holder->vpublic()->add(lccc::cc_member::make("int *", "p"));
+	auto move(holder->vpublic()->add(holder->make_move_constructor()));
+	holder->vpublic()->add(holder->make_move_assignment());
+	CPPUNIT_ASSERT_EQUAL(std::string("std::is_nothrow_move_constructible<thrower>::value"),
+		move->noexcept_condition());
+
+	std::ostringstream code;
+	code
+		<< "#include <memory>\n"
+		<< "#include <string>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <utility>\n"
+		<< "#include <vector>\n";
+	base->print(code);
+	src->print(code);
+	code << R"(
+struct thrower {
+	thrower() { }
+	thrower(thrower &&) { }
+	thrower & operator=(thrower &&) { return *this; }
+};
+)";
+	holder->print(code);
+	code << R"(
+int record::instances(0);
+
+static_assert(std::is_nothrow_move_constructible<record>::value, "move constructor");
+static_assert(std::is_nothrow_move_assignable<record>::value, "move assignment");
+static_assert(!std::is_copy_constructible<record>::value, "copy constructor");
+static_assert(!std::is_nothrow_move_constructible<holder>::value, "throwing move constructor");
+static_assert(!std::is_nothrow_move_assignable<holder>::value, "throwing move assignment");
+
+int main()
+{
+	record a;
+	a.name = "a";
+	a.values = {1, 2, 3};
+	a.extra.reset(new int(7));
+	a.count = 3;
+	record b(std::move(a));
+	int res(b.name == "a" && b.values.size() == 3 && *b.extra == 7 && b.count == 3 ? 0 : 1);
+	res |= a.values.empty() && !a.extra ? 0 : 1;
+	record c;
+	c = std::move(b);
+	res |= c.name == "a" && c.values.size() == 3 && *c.extra == 7 && !b.extra ? 0 : 1;
+	std::vector<record> v(4);
+	v.reserve(100);
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_pool_compile()
+{
+	auto src(lccc::cc_class::make("message"));
+	auto ctor(src->vpublic()->add(src->make_constructor()));
+	ctor->add_arg("int", "id");
+	ctor->add_arg("double", "value");
+	ctor->add(lccc::cc_base_class::make("id_")->make_initializer("id"));
+	ctor->add(lccc::cc_base_class::make("value_")->make_initializer("value"));
+	ctor->define(lccc::cc_block::make());
+	auto dtor(src->vpublic()->add(src->make_destructor()));
+	dtor->make_virtual();
+	dtor->define(lccc::cc_block::make())->src() << "++destroyed;\n";
+	auto id(src->vpublic()->add(lccc::cc_method::make("int", "id")));
+	id->make_const();
+	id->define(lccc::cc_block::make())->src() << "return id_;\n";
+	src->vpublic()->add(lccc::cc_member::make("static int", "destroyed"));
+	src->vprivate()->add(lccc::cc_member::make("int", "id_"));
+	src->vprivate()->add(lccc::cc_member::make("double", "value_"));
+	src->pool(4);
+	CPPUNIT_ASSERT_THROW(lccc::cc_class::make("empty")->pool(0), std::invalid_argument);
+
+	std::ostringstream code;
+	code
+		<< "#include <cstddef>\n"
+		<< "#include <cstdint>\n"
+		<< "#include <memory>\n"
+		<< "#include <mutex>\n"
+		<< "#include <new>\n"
+		<< "#include <utility>\n"
+		<< "#include <vector>\n";
+	src->print(code);
+	code << R"(
+int message::destroyed(0);
+
+class large : public message {
+public:
+	large() : message(-1, 0) { }
+	char payload[256];
+};
+
+int main()
+{
+	int res(0);
+	std::vector<message*> all;
+	for (int i(0); i < 100; ++i) {
+		all.push_back(new message(i, i * 0.5));
+	}
+	for (int i(0); i < 100; ++i) {
+		res |= all[i]->id() == i ? 0 : 1;
+		res |= reinterpret_cast<std::uintptr_t>(all[i]) % alignof(message) == 0 ? 0 : 1;
+	}
+	message* last(all.back());
+	all.pop_back();
+	delete last;
+	message* again(new message(7, 7));
+	res |= again == last ? 0 : 1;
+	all.push_back(again);
+	for (auto m: all) {
+		delete m;
+	}
+
+	auto pooled(message::make_pooled(42, 1.5));
+	res |= pooled->id() == 42 ? 0 : 1;
+	pooled.reset();
+
+	message* derived(new large());
+	res |= derived->id() == -1 ? 0 : 1;
+	delete derived;
+
+	alignas(message) unsigned char buffer[sizeof(message)];
+	message* placed(new (buffer) message(3, 3));
+	res |= placed->id() == 3 ? 0 : 1;
+	placed->~message();
+
+	res |= message::destroyed == 104 ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_serialize()
+{
+	auto src(lccc::cc_class::make("point"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "x"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "y"));
+	src->vpublic()->add(lccc::cc_member::make("char", "tag"));
+	src->serialize();
+	std::ostringstream out;
+	src->print(out);
+	std::string expected(
+		"class point {\n"
+		"public:\n"
+		"\tstd::int32_t x;\n"
+		"\tstd::int32_t y;\n"
+		"\tchar tag;\n"
+		"\tstatic constexpr std::size_t serialized_size()\n"
+		"\t{\n"
+		"\t\treturn sizeof(x) + sizeof(y) + sizeof(tag);\n"
+		"\t}\n"
+		"\n"
+		"\tvoid serialize(char* out) const\n"
+		"\t{\n"
+		"\t\t#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__\n"
+		"\t\tstd::memcpy(out, &x, sizeof(x) + sizeof(y) + sizeof(tag));\n"
+		"\t\tout += sizeof(x) + sizeof(y) + sizeof(tag);\n"
+		"\t\t#else\n"
+		"\t\t{\n"
+		"\t\t\tstd::uint32_t bytes;\n"
+		"\t\t\tstd::memcpy(&bytes, &x, 4);\n"
+		"\t\t\tbytes = __builtin_bswap32(bytes);\n"
+		"\t\t\tstd::memcpy(out, &bytes, 4);\n"
+		"\t\t}\n"
+		"\t\tout += 4;\n"
+		"\t\t{\n"
+		"\t\t\tstd::uint32_t bytes;\n"
+		"\t\t\tstd::memcpy(&bytes, &y, 4);\n"
+		"\t\t\tbytes = __builtin_bswap32(bytes);\n"
+		"\t\t\tstd::memcpy(out, &bytes, 4);\n"
+		"\t\t}\n"
+		"\t\tout += 4;\n"
+		"\t\tstd::memcpy(out, &tag, sizeof(tag));\n"
+		"\t\tout += sizeof(tag);\n"
+		"\t\t#endif\n"
+		"\t}\n"
+		"\n");
+	CPPUNIT_ASSERT_EQUAL(expected, out.str().substr(0, expected.size()));
+
+	auto pointer(lccc::cc_class::make("pointer"));
+	pointer->vpublic()->add(lccc::cc_member::make("int*", "p"));
+	CPPUNIT_ASSERT_THROW(pointer->serialize(), std::invalid_argument);
+	auto wide(lccc::cc_class::make("wide"));
+	wide->vpublic()->add(lccc::cc_member::make("long double", "value"));
+	CPPUNIT_ASSERT_THROW(wide->serialize(lccc::cc_class::byte_order::big), std::invalid_argument);
+	CPPUNIT_ASSERT_THROW(lccc::cc_class::make("empty")->serialize(), std::invalid_argument);
+}
+
+lccc::cc_class::ptr_t make_record(std::string const& name, lccc::cc_class::byte_order order)
+{
+	auto src(lccc::cc_class::make(name));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "id"));
+	src->vpublic()->add(lccc::cc_member::make("std::uint8_t", "kind"));
+	src->vpublic()->add(lccc::cc_member::make("bool", "valid"));
+	src->vpublic()->add(lccc::cc_member::make("std::uint16_t", "port"));
+	src->vpublic()->add(lccc::cc_member::make("double", "value"));
+	src->vpublic()->add(lccc::cc_member::make("float", "scale"));
+	src->vpublic()->add(lccc::cc_member::make("char", "code"));
+	src->vpublic()->add(lccc::cc_member::make("std::int64_t", "stamp"));
+	src->vpublic()->add(lccc::cc_member::make("color", "shade"));
+	src->vpublic()->add(lccc::cc_member::make("inner", "nested"));
+	src->vprivate()->add(lccc::cc_member::make("std::uint64_t", "secret_"));
+	auto get(src->vpublic()->add(lccc::cc_method::make("std::uint64_t&", "secret")));
+	get->define(lccc::cc_block::make())->src() << "return secret_;\n";
+	src->serialize(order);
+	return src;
+}
+
+void test::test_serialize_compile()
+{
+	std::ostringstream code;
+	code
+		<< "#include <cstddef>\n"
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <type_traits>\n"
+		<< "enum class color : std::uint16_t { red = 0x102, green };\n";
+	// in its own byte order
+	auto inner(lccc::cc_class::make("inner"));
+	inner->vpublic()->add(lccc::cc_member::make("std::uint16_t", "a"));
+	inner->vpublic()->add(lccc::cc_member::make("color", "c"));
+	inner->serialize(lccc::cc_class::byte_order::big);
+	inner->print(code);
+	make_record("little", lccc::cc_class::byte_order::little)->print(code);
+	make_record("big", lccc::cc_class::byte_order::big)->print(code);
+	code << R"(
+template <typename T>
+int round_trip(unsigned char const* head, unsigned char const* tail)
+{
+	T a;
+	a.id = -2;
+	a.kind = 200;
+	a.valid = true;
+	a.port = 0x1234;
+	a.value = -1.25;
+	a.scale = 3.5f;
+	a.code = 'x';
+	a.stamp = -0x123456789;
+	a.shade = color::green;
+	a.nested.a = 0x0a0b;
+	a.nested.c = color::red;
+	a.secret() = 0xfedcba9876543210;
+
+	char buf[T::serialized_size()];
+	std::memset(buf, 0, sizeof(buf));
+	a.serialize(buf);
+	int res(std::memcmp(buf, head, 8) == 0 ? 0 : 1);
+	res |= std::memcmp(buf + 29, tail, 6) == 0 ? 0 : 1;
+
+	T b;
+	b.deserialize(buf);
+	res |= b.id == a.id && b.kind == a.kind && b.valid && b.port == a.port ? 0 : 1;
+	res |= b.value == a.value && b.scale == a.scale && b.code == a.code ? 0 : 1;
+	res |= b.stamp == a.stamp && b.shade == color::green && b.secret() == a.secret() ? 0 : 1;
+	res |= b.nested.a == 0x0a0b && b.nested.c == color::red ? 0 : 1;
+	return res;
+}
+
+static_assert(little::serialized_size() == 4 + 1 + 1 + 2 + 8 + 4 + 1 + 8 + 2 + 4 + 8, "packed size");
+
+int main()
+{
+	unsigned char const le[] = {0xfe, 0xff, 0xff, 0xff, 200, 1, 0x34, 0x12};
+	unsigned char const be[] = {0xff, 0xff, 0xff, 0xfe, 200, 1, 0x12, 0x34};
+	unsigned char const le_tail[] = {0x03, 0x01, 0x0a, 0x0b, 0x01, 0x02};
+	unsigned char const be_tail[] = {0x01, 0x03, 0x0a, 0x0b, 0x01, 0x02};
+	return round_trip<little>(le, le_tail) | round_trip<big>(be, be_tail);
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_hashable()
+{
+	auto src(lccc::cc_class::make("key"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "a"));
+	src->vpublic()->add(lccc::cc_member::make("std::int16_t", "b"));
+	src->vpublic()->add(lccc::cc_member::make("std::int16_t", "c"));
+	src->vpublic()->add(lccc::cc_member::make("double", "d"));
+	src->vpublic()->add(lccc::cc_member::make("bool", "e"));
+	src->vpublic()->add(lccc::cc_member::make("std::int64_t", "f"));
+	auto spec(src->hashable("ns::key"));
+
+	std::ostringstream out;
+	src->print(out);
+	std::string expected(
+		"\tbool operator==(key const& other) const\n"
+		"\t{\n"
+		"\t\treturn std::memcmp(&a, &other.a, sizeof(a) + sizeof(b) + sizeof(c)) == 0\n"
+		"\t\t\t&& d == other.d\n"
+		"\t\t\t&& e == other.e\n"
+		"\t\t\t&& f == other.f;\n"
+		"\t}\n");
+	CPPUNIT_ASSERT(out.str().find(expected) != std::string::npos);
+
+	std::ostringstream hash;
+	spec->print(hash);
+	CPPUNIT_ASSERT(hash.str().find("struct hash<ns::key> {\n") != std::string::npos);
+	CPPUNIT_ASSERT_THROW(lccc::cc_class::make("empty")->hashable(), std::invalid_argument);
+}
+
+void test::test_hashable_compile()
+{
+	auto src(lccc::cc_class::make("key"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "id"));
+	src->vpublic()->add(lccc::cc_member::make("std::uint8_t", "kind"));
+	src->vpublic()->add(lccc::cc_member::make("bool", "valid"));
+	src->vpublic()->add(lccc::cc_member::make("std::uint16_t", "port"));
+	src->vpublic()->add(lccc::cc_member::make("double", "weight"));
+	src->vpublic()->add(lccc::cc_member::make("std::string", "name"));
+	src->vpublic()->add(lccc::cc_member::make("float", "scale"));
+	src->vpublic()->add(lccc::cc_member::make("char", "code"));
+	src->vpublic()->add(lccc::cc_member::make("long double", "precise"));
+	src->vpublic()->add(lccc::cc_member::make("color", "shade"));
+	auto ns(lccc::cc_namespace::make("ns"));
+	ns->add(src);
+	auto spec(src->hashable("ns::key"));
+
+	std::ostringstream code;
+	code
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <functional>\n"
+		<< "#include <string>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <unordered_map>\n"
+		<< "#include <unordered_set>\n"
+		<< "enum class color : std::uint8_t { red, green };\n";
+	ns->print(code);
+	spec->print(code);
+	code << R"(
+ns::key make(int i)
+{
+	ns::key k;
+	std::memset(static_cast<void*>(&k), 0xa5, sizeof(k));
+	new (&k.name) std::string("key" + std::to_string(i % 7));
+	k.id = i;
+	k.kind = std::uint8_t(i % 3);
+	k.valid = i % 2 == 0;
+	k.port = std::uint16_t(i * 7);
+	k.weight = i * 0.5;
+	k.scale = 1.0f;
+	k.code = 'c';
+	k.precise = i / 3.0L;
+	k.shade = color(i % 2);
+	return k;
+}
+
+int main()
+{
+	int res(0);
+	std::unordered_map<ns::key, int> map;
+	for (int i(0); i < 1000; ++i) {
+		map[make(i)] = i;
+	}
+	res |= map.size() == 1000 ? 0 : 1;
+	for (int i(0); i < 1000; ++i) {
+		auto k(make(i));
+		res |= map.at(k) == i ? 0 : 1;
+		res |= std::hash<ns::key>()(k) == std::hash<ns::key>()(make(i)) ? 0 : 1;
+	}
+
+	ns::key a(make(1));
+	ns::key b(make(1));
+	a.weight = 0.0;
+	b.weight = -0.0;
+	res |= a == b && std::hash<ns::key>()(a) == std::hash<ns::key>()(b) ? 0 : 1;
+	a.precise = 0.0L;
+	b.precise = -0.0L;
+	std::memset(reinterpret_cast<char*>(&b.precise) + 10, 0x5a, sizeof(long double) - 10);
+	res |= a == b && std::hash<ns::key>()(a) == std::hash<ns::key>()(b) ? 0 : 1;
+	b.precise = 1e30L;
+	res |= a != b ? 0 : 1;
+	b.precise = a.precise;
+	b.port = 8;
+	res |= a != b ? 0 : 1;
+	b = a;
+	b.name = "other";
+	res |= a != b ? 0 : 1;
+
+	std::unordered_set<std::size_t> hashes;
+	for (int i(0); i < 1000; ++i) {
+		hashes.insert(std::hash<ns::key>()(make(i)));
+	}
+	res |= hashes.size() == 1000 ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_reflect_compile()
+{
+	auto src(lccc::cc_class::make("point"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "x"));
+	src->vpublic()->add(lccc::cc_member::make("std::int32_t", "y"));
+	src->vpublic()->add(lccc::cc_member::make("double", "z"));
+	src->vpublic()->add(lccc::cc_member::make("char", "tag"));
+	src->vpublic()->add(lccc::cc_member::make("std::uint16_t", "id"));
+	src->vpublic()->add(lccc::cc_member::make("static int", "count"));
+	auto ns(lccc::cc_namespace::make("geo"));
+	ns->add(src);
+	ns->add(src->reflect());
+	CPPUNIT_ASSERT_THROW(lccc::cc_class::make("empty")->reflect(), std::invalid_argument);
+
+	std::ostringstream code;
+	code
+		<< "#include <cstddef>\n"
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <stdexcept>\n";
+	ns->print(code);
+	code << R"(
+constexpr bool same(char const* a, char const* b)
+{
+	return *a == *b && (*a == 0 || same(a + 1, b + 1));
+}
+
+static_assert(geo::point::field_count() == 5, "static members are skipped");
+static_assert(sizeof(geo::point_fields) / sizeof(geo::point_fields[0]) == 5, "one entry per field");
+static_assert(same(geo::point_fields[2].name, "z"), "name");
+static_assert(geo::point_fields[0].offset == 0 && geo::point_fields[1].offset == 4, "offsets");
+static_assert(geo::point_fields[2].offset == 8 && geo::point_fields[3].offset == 16, "offsets");
+static_assert(geo::point_fields[4].offset == offsetof(geo::point, id), "offsets");
+static_assert(geo::point_fields[2].size == sizeof(double) && geo::point::field(4).size == 2, "sizes");
+static_assert(same(geo::point_fields[4].type, "std::uint16_t"), "type");
+static_assert(geo::point_fields[0].type_id == geo::point_fields[1].type_id, "same type");
+static_assert(geo::point_fields[0].type_id != geo::point_fields[2].type_id, "other type");
+
+int main()
+{
+	geo::point p;
+	p.x = 1;
+	p.y = 2;
+	p.z = 3;
+	p.tag = 't';
+	p.id = 5;
+	std::int32_t y;
+	auto const& field(geo::point_fields[1]);
+	std::memcpy(&y, reinterpret_cast<char const*>(&p) + field.offset, field.size);
+	int res(y == 2 ? 0 : 1);
+	try {
+		std::size_t index(5);
+		geo::point::field(index);
+		res |= 1;
+	} catch (std::out_of_range const&) {
+	}
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
 }
 
 }}
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <sstream>
+#include <vector>
 #include <cppunit/extensions/HelperMacros.h>
 #include <lccc/cpp.h>
 #include <lccc/header.h>
@@ -19,6 +21,10 @@ private:
 	void test_ifndef();
 	void test_guard();
 	void test_header();
+	void test_include_local();
+	void test_header_includes();
+	void test_header_deterministic();
+	void test_lazy();
 
 	CPPUNIT_TEST_SUITE(test);
 	CPPUNIT_TEST(test_define);
@@ -27,6 +33,10 @@ private:
 	CPPUNIT_TEST(test_ifndef);
 	CPPUNIT_TEST(test_guard);
 	CPPUNIT_TEST(test_header);
+	CPPUNIT_TEST(test_include_local);
+	CPPUNIT_TEST(test_header_includes);
+	CPPUNIT_TEST(test_header_deterministic);
+	CPPUNIT_TEST(test_lazy);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -117,5 +127,116 @@ void test::test_header()
 	CPPUNIT_ASSERT_EQUAL(expected, out.str());
 }
 
-}}
+void test::test_lazy()
+{
+	auto def(lccc::cpp_ifdef::make("FOOBAR"));
+	def->add(lccc::lazy::make([](lccc::lazy::emit_t const& emit) {
+		emit(lccc::cpp_define::make("FOO"));
+		emit(lccc::cpp_define::make("BAR"));
+	}));
+	std::stringstream out;
+	def->print(out);
+	std::string expected(
+		"#ifdef FOOBAR\n"
+		"#define FOO\n"
+		"#define BAR\n"
+		"#endif\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
 
+void test::test_include_local()
+{
+	auto def(lccc::cpp_include::make_local("foo/bar.h"));
+	std::stringstream out;
+	def->print(out);
+	std::string expected("#include \"foo/bar.h\"\n");
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_header_includes()
+{
+	auto def(lccc::header::make("foo.h"));
+	def->add(lccc::cpp_include::make("vector"));
+	def->add(lccc::cpp_define::make("FOO"));
+	def->add(lccc::cpp_include::make_local("foo/b.h"));
+	def->add(lccc::cpp_include::make("string"));
+	def->add(lccc::cpp_include::make("vector"));
+	def->add(lccc::cpp_include::make_local("foo/a.h"));
+	def->add(lccc::cpp_include::make_local("foo/b.h"));
+	def->add(lccc::cpp_include::make_local("string"));
+	std::stringstream out;
+	def->print(out);
+	std::string expected(
+		"#ifndef FOO_H\n"
+		"#define FOO_H\n"
+		"#include<vector>\n"
+		"#include<string>\n"
+		"#include \"foo/b.h\"\n"
+		"#include \"foo/a.h\"\n"
+		"#include \"string\"\n"
+		"#define FOO\n"
+		"#endif\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+
+	def->make_deterministic();
+	out.str("");
+	def->print(out);
+	expected =
+		"#ifndef FOO_H\n"
+		"#define FOO_H\n"
+		"#include<string>\n"
+		"#include<vector>\n"
+		"#include \"foo/a.h\"\n"
+		"#include \"foo/b.h\"\n"
+		"#include \"string\"\n"
+		"#define FOO\n"
+		"#endif\n";
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_header_deterministic()
+{
+	std::vector<lccc::cpp_include::ptr_t> includes{
+		lccc::cpp_include::make("cstdint"),
+		lccc::cpp_include::make("map"),
+		lccc::cpp_include::make("cstdint"),
+		lccc::cpp_include::make_local("gen/a.h"),
+		lccc::cpp_include::make_local("gen/b.h"),
+		lccc::cpp_include::make("algorithm"),
+		lccc::cpp_include::make_local("gen/a.h"),
+	};
+	std::vector<std::size_t> order{0, 1, 2, 3, 4, 5, 6};
+
+	std::string first;
+	do {
+		auto def(lccc::header::make("gen/out.h"));
+		def->make_deterministic();
+		def->add(lccc::cpp_define::make("OUT 1"));
+		for (auto i: order) {
+			def->add(includes[i]);
+		}
+		std::stringstream out;
+		def->print(out);
+		if (first.empty()) {
+			first = out.str();
+		}
+		CPPUNIT_ASSERT_EQUAL(first, out.str());
+	} while (std::next_permutation(order.begin(), order.end()));
+
+	std::string expected(
+		"#ifndef GEN_OUT_H\n"
+		"#define GEN_OUT_H\n"
+		"#include<algorithm>\n"
+		"#include<cstdint>\n"
+		"#include<map>\n"
+		"#include \"gen/a.h\"\n"
+		"#include \"gen/b.h\"\n"
+		"#define OUT 1\n"
+		"#endif\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, first);
+}
+
+}}
@@ -0,0 +1,253 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/crtp.h>
+#include "compile.h"
+
+namespace unittests {
+namespace crtp {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_base();
+	void test_compile();
+	void test_derive();
+	void test_noexcept_compile();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_base);
+	CPPUNIT_TEST(test_compile);
+	CPPUNIT_TEST(test_derive);
+	CPPUNIT_TEST(test_noexcept_compile);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+lccc::cc_class::ptr_t make_shape()
+{
+	auto shape(lccc::cc_class::make("shape"));
+	auto area(shape->vpublic()->add(lccc::cc_method::make("double", "area")));
+	area->make_abstract();
+	area->make_const();
+	auto scale(shape->vpublic()->add(lccc::cc_method::make("void", "scale")));
+	scale->add_arg("double");
+	scale->make_abstract();
+	auto label(shape->vpublic()->add(lccc::cc_method::make("std::string", "label")));
+	label->add_arg("std::string", "prefix");
+	label->make_abstract();
+	label->make_const();
+	auto dtor(shape->vpublic()->add(shape->make_destructor()));
+	dtor->make_virtual();
+	dtor->make_default();
+	return shape;
+}
+
+lccc::cc_class::ptr_t make_square(std::string const& name)
+{
+	auto square(lccc::cc_class::make(name));
+	square->add(lccc::cc_base_class::make("shape"));
+	auto ctor(square->vpublic()->add(square->make_constructor()));
+	ctor->add_arg("double", "side");
+	ctor->add(lccc::cc_base_class::make("side_")->make_initializer("side"));
+	ctor->define(lccc::cc_block::make());
+	auto area(square->vpublic()->add(lccc::cc_method::make("double", "area")));
+	area->make_virtual();
+	area->make_const();
+	area->make_final();
+	area->define(lccc::cc_block::make())->src() << "return side_ * side_;\n";
+	auto scale(square->vpublic()->add(lccc::cc_method::make("void", "scale")));
+	scale->add_arg("double", "factor");
+	scale->make_virtual();
+	scale->define(lccc::cc_block::make())->src() << "side_ *= factor;\n";
+	auto label(square->vpublic()->add(lccc::cc_method::make("std::string", "label")));
+	label->add_arg("std::string", "prefix");
+	label->make_virtual();
+	label->make_const();
+	label->define(lccc::cc_block::make())->src() << "return prefix + \"square\";\n";
+	square->vprivate()->add(lccc::cc_member::make("double", "side_"));
+	return square;
+}
+
+void test::test_base()
+{
+	std::ostringstream os;
+	lccc::cc_crtp::make(make_shape())->base()->print(os);
+	CPPUNIT_ASSERT_EQUAL(std::string(
+		"template <typename Derived>\n"
+		"class shape_crtp {\n"
+		"public:\n"
+		"\tdouble area() const\n"
+		"\t{\n"
+		"\t\treturn static_cast<Derived const*>(this)->area();\n"
+		"\t}\n"
+		"\n"
+		"\tvoid scale(double arg0)\n"
+		"\t{\n"
+		"\t\treturn static_cast<Derived*>(this)->scale(std::forward<double>(arg0));\n"
+		"\t}\n"
+		"\n"
+		"\tstd::string label(std::string prefix) const\n"
+		"\t{\n"
+		"\t\treturn static_cast<Derived const*>(this)->label(std::forward<std::string>(prefix));\n"
+		"\t}\n"
+		"\n"
+		"protected:\n"
+		"\t~shape_crtp() = default;\n"
+		"};\n"), os.str());
+}
+
+void test::test_compile()
+{
+	auto shape(make_shape());
+	auto crtp(lccc::cc_crtp::make(shape));
+	auto dynamic(make_square("square_v"));
+	auto fixed(make_square("square_s"));
+	crtp->derive(fixed);
+
+	std::ostringstream code;
+	code
+		<< "#include <string>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <utility>\n";
+	shape->print(code);
+	crtp->base()->print(code);
+	crtp->adapter()->print(code);
+	dynamic->print(code);
+	fixed->print(code);
+	code << R"(
+template <typename T>
+double run(shape_crtp<T> & s)
+{
+	s.scale(2);
+	return s.area();
+}
+
+double run(shape & s)
+{
+	s.scale(2);
+	return s.area();
+}
+
+static_assert(std::is_polymorphic<square_v>::value, "square_v is virtual");
+static_assert(!std::is_polymorphic<square_s>::value, "square_s is static");
+static_assert(sizeof(square_s) == sizeof(double), "square_s has no vptr");
+
+int main()
+{
+	square_v v(3);
+	square_s s(3);
+	shape_adapter<square_s> a(square_s(3));
+	shape & any(a);
+	int res(0);
+	res |= run(v) == 36 ? 0 : 1;
+	res |= run(s) == 36 ? 0 : 1;
+	res |= run(any) == 36 && a.get().area() == 36 ? 0 : 1;
+	res |= v.label("a ") == s.label("a ") && any.label("a ") == "a square" ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_derive()
+{
+	auto crtp(lccc::cc_crtp::make(make_shape()));
+	auto other(make_square("other"));
+	CPPUNIT_ASSERT(other->replace("shape", lccc::cc_base_class::make("polygon")));
+	CPPUNIT_ASSERT_THROW(crtp->derive(other), std::invalid_argument);
+
+	auto partial(lccc::cc_class::make("partial"));
+	partial->add(lccc::cc_base_class::make("shape"));
+	CPPUNIT_ASSERT_THROW(crtp->derive(partial), std::invalid_argument);
+
+	CPPUNIT_ASSERT_THROW(lccc::cc_crtp::make(lccc::cc_class::make("empty"))->base(),
+		std::invalid_argument);
+}
+
+void test::test_noexcept_compile()
+{
+	auto counter(lccc::cc_class::make("counter"));
+	auto count(counter->vpublic()->add(lccc::cc_method::make("int", "count")));
+	count->make_abstract();
+	count->make_const();
+	count->make_noexcept();
+	count->add_attribute("gnu::pure");
+	auto dtor(counter->vpublic()->add(counter->make_destructor()));
+	dtor->make_virtual();
+	dtor->make_default();
+	auto crtp(lccc::cc_crtp::make(counter));
+
+	auto impl(lccc::cc_class::make("fixed"));
+	impl->add(lccc::cc_base_class::make("counter"));
+	auto impl_count(impl->vpublic()->add(lccc::cc_method::make("int", "count")));
+	impl_count->make_virtual();
+	impl_count->make_const();
+	impl_count->make_noexcept();
+	impl_count->define(lccc::cc_block::make())->src() << "return 3;\n";
+	crtp->derive(impl);
+
+	std::ostringstream adapter;
+	crtp->adapter()->print(adapter);
+	CPPUNIT_ASSERT(adapter.str().find("[[gnu::pure]] virtual int count() const noexcept final") != std::string::npos);
+
+	std::ostringstream code;
+	code << "#include <utility>\n";
+	counter->print(code);
+	crtp->base()->print(code);
+	crtp->adapter()->print(code);
+	impl->print(code);
+	code << R"(
+int main()
+{
+	fixed f;
+	counter_adapter<fixed> a{fixed()};
+	counter const& any(a);
+	static_assert(noexcept(f.count()), "count() is noexcept");
+	static_assert(noexcept(any.count()), "count() is noexcept");
+	return f.count() == 3 && any.count() == 3 ? 0 : 1;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+}}
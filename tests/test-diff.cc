@@ -0,0 +1,246 @@
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/cc.h>
+#include <lccc/diff.h>
+#include <lccc/header.h>
+
+namespace unittests {
+namespace diff {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_unchanged();
+	void test_namespace();
+	void test_class();
+	void test_visibility();
+	void test_method();
+	void test_files();
+	void test_lazy();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_unchanged);
+	CPPUNIT_TEST(test_namespace);
+	CPPUNIT_TEST(test_class);
+	CPPUNIT_TEST(test_visibility);
+	CPPUNIT_TEST(test_method);
+	CPPUNIT_TEST(test_files);
+	CPPUNIT_TEST(test_lazy);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+namespace {
+
+struct tree {
+	tree()
+	:
+		hdr(lccc::header::make("foo.h")),
+		ns(lccc::cc_namespace::make("foo")),
+		bar(lccc::cc_class::make("bar")),
+		baz(lccc::cc_class::make("baz")),
+		get(lccc::cc_method::make("int", "get"))
+	{
+		hdr->add(ns);
+		ns->add(bar);
+		ns->add(baz);
+		auto body(lccc::cc_block::make());
+		body->src() << "return x_;\n";
+		get->define(body);
+		bar->vpublic()->add(get);
+		bar->vprivate()->add(lccc::cc_member::make("int", "x_"));
+		bar->vprivate()->add(lccc::cc_member::make("int", "y_"));
+		baz->vpublic()->add(lccc::cc_method::make("void", "run"));
+	}
+
+	lccc::header::ptr_t hdr;
+	lccc::cc_namespace::ptr_t ns;
+	lccc::cc_class::ptr_t bar;
+	lccc::cc_class::ptr_t baz;
+	lccc::cc_method::ptr_t get;
+};
+
+std::string path(lccc::change const& c)
+{
+	std::string res;
+	std::string sep;
+	for (auto const& p: c.path) {
+		res += sep + p;
+		sep = "/";
+	}
+	return res;
+}
+
+}
+
+void test::test_unchanged()
+{
+	tree t1;
+	tree t2;
+	CPPUNIT_ASSERT(lccc::diff(*t1.hdr, *t2.hdr).empty());
+}
+
+void test::test_namespace()
+{
+	tree t1;
+	tree t2;
+	auto ns(lccc::cc_namespace::make("qux"));
+	t2.hdr->add(ns);
+	auto changes(lccc::diff(*t1.hdr, *t2.hdr));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::added);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_namespace);
+	CPPUNIT_ASSERT_EQUAL(std::string("qux"), path(changes[0]));
+	CPPUNIT_ASSERT(changes[0].new_node == ns.get());
+
+	changes = lccc::diff(*t2.hdr, *t1.hdr);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::removed);
+	CPPUNIT_ASSERT(changes[0].old_node == ns.get());
+}
+
+void test::test_class()
+{
+	tree t1;
+	tree t2;
+	t2.ns = lccc::cc_namespace::make("foo");
+	t2.hdr = lccc::header::make("foo.h");
+	t2.hdr->add(t2.ns);
+	t2.ns->add(t2.bar);
+
+	auto changes(lccc::diff(*t1.hdr, *t2.hdr));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::removed);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_class);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/baz"), path(changes[0]));
+
+	tree t3;
+	t3.baz->add(lccc::cc_base_class::make("base"));
+	changes = lccc::diff(*t1.hdr, *t3.hdr);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::added);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_base_class);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/baz/base"), path(changes[0]));
+}
+
+void test::test_visibility()
+{
+	tree t1;
+	tree t2;
+	t2.bar->vprotected()->add(lccc::cc_member::make("int", "z_"));
+	auto changes(lccc::diff(*t1.hdr, *t2.hdr));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::added);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/bar/protected/z_"), path(changes[0]));
+
+	// reordered members change the section as a whole
+	tree t3;
+	t3.bar = lccc::cc_class::make("bar");
+	t3.bar->vpublic()->add(t3.get);
+	t3.bar->vprivate()->add(lccc::cc_member::make("int", "y_"));
+	t3.bar->vprivate()->add(lccc::cc_member::make("int", "x_"));
+	t3.ns = lccc::cc_namespace::make("foo");
+	t3.ns->add(t3.bar);
+	t3.ns->add(t3.baz);
+	t3.hdr = lccc::header::make("foo.h");
+	t3.hdr->add(t3.ns);
+	changes = lccc::diff(*t1.hdr, *t3.hdr);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::modified);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_visibility);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/bar/private"), path(changes[0]));
+}
+
+void test::test_method()
+{
+	tree t1;
+	tree t2;
+	auto body(lccc::cc_block::make());
+	body->src() << "return y_;\n";
+	t2.get->define(body);
+	t2.baz->vpublic()->add(lccc::cc_method::make("void", "stop"));
+
+	auto changes(lccc::diff(*t1.hdr, *t2.hdr));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(2), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::modified);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_method);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/bar/public/get"), path(changes[0]));
+	CPPUNIT_ASSERT(changes[0].old_node == t1.get.get());
+	CPPUNIT_ASSERT(changes[0].new_node == t2.get.get());
+	CPPUNIT_ASSERT(changes[1].what == lccc::change::type::added);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/baz/public/stop"), path(changes[1]));
+
+	// overloads are told apart by their arguments
+	tree t3;
+	auto run(lccc::cc_method::make("void", "run"));
+	run->add_arg("int");
+	t3.baz->vpublic()->add(run);
+	changes = lccc::diff(*t1.hdr, *t3.hdr);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::added);
+	CPPUNIT_ASSERT(changes[0].new_node == run.get());
+}
+
+void test::test_files()
+{
+	tree t1;
+	tree t2;
+	lccc::file_map old_files{
+		{"a.h", lccc::header::make("a.h")},
+		{"foo.h", t1.hdr},
+		{"gone.h", lccc::header::make("gone.h")},
+	};
+	t2.get->make_const();
+	lccc::file_map new_files{
+		{"a.h", lccc::header::make("a.h")},
+		{"foo.h", t2.hdr},
+		{"new.h", lccc::header::make("new.h")},
+	};
+
+	auto changes(lccc::diff(old_files, new_files));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(3), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::removed);
+	CPPUNIT_ASSERT_EQUAL(std::string("gone.h"), path(changes[0]));
+	CPPUNIT_ASSERT(changes[1].what == lccc::change::type::modified);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo.h"), path(changes[1]));
+	CPPUNIT_ASSERT(changes[2].what == lccc::change::type::added);
+	CPPUNIT_ASSERT_EQUAL(std::string("new.h"), path(changes[2]));
+}
+
+void test::test_lazy()
+{
+	auto producer([](lccc::lazy::emit_t const& emit) {
+		emit(lccc::cc_member::make("int", "w_"));
+	});
+	tree t1;
+	tree t2;
+	t1.baz->vprivate()->add(lccc::lazy::make(producer));
+	t2.baz->vprivate()->add(lccc::lazy::make(producer));
+
+	// the section holding the lazy node is reported, bar is skipped
+	auto changes(lccc::diff(*t1.hdr, *t2.hdr));
+	CPPUNIT_ASSERT_EQUAL(std::size_t(1), changes.size());
+	CPPUNIT_ASSERT(changes[0].what == lccc::change::type::modified);
+	CPPUNIT_ASSERT(changes[0].kind == lccc::snapshot::kind::cc_visibility);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/baz/private"), path(changes[0]));
+
+	auto root(lccc::lazy::make(producer));
+	CPPUNIT_ASSERT_THROW(lccc::diff(*root, *root), std::invalid_argument);
+}
+
+}}
@@ -0,0 +1,186 @@
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/lookup.h>
+#include "compile.h"
+
+namespace unittests {
+namespace lookup {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_compile();
+	void test_duplicate();
+	void test_enum();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_compile);
+	CPPUNIT_TEST(test_duplicate);
+	CPPUNIT_TEST(test_enum);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+namespace {
+
+std::vector<std::string> make_keys()
+{
+	std::vector<std::string> keys{
+		"if", "else", "for", "while", "do", "switch", "case", "return",
+		"", "a\"b?\\c", std::string("nul\0nul", 7), "\xff\x01",
+	};
+	for (unsigned i(0); i < 3000; ++i) {
+		keys.push_back("key_" + std::to_string(i));
+	}
+	return keys;
+}
+
+std::string literal(std::string const& key)
+{
+	std::ostringstream res;
+	res << "std::string(\"";
+	for (auto c: key) {
+		res << "\\x" << std::hex << unsigned(static_cast<unsigned char>(c)) << "\" \"";
+	}
+	res << "\", " << std::dec << key.size() << ")";
+	return res.str();
+}
+
+
+}
+
+// the generated lookup is compiled and run against the whole key set
+void test::test_compile()
+{
+	auto keys(make_keys());
+	auto lookup(lccc::cc_lookup::make("token", "find", "token::none"));
+	for (std::size_t i(0); i < keys.size(); ++i) {
+		lookup->add(keys[i], "token(" + std::to_string(i + 1) + ")");
+	}
+
+	std::ostringstream out;
+	out
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <string>\n"
+		<< "enum class token { none };\n";
+	lookup->generate()->print(out);
+	lccc::cc_lookup::make("token", "empty", "token::none")->generate()->print(out);
+	out
+		<< "int check(std::string const& key, int expected)\n"
+		<< "{\n"
+		<< "\treturn int(find(key.data(), key.size())) == expected ? 0 : 1;\n"
+		<< "}\n"
+		<< "int main()\n"
+		<< "{\n"
+		<< "\tint res(0);\n";
+	for (std::size_t i(0); i < keys.size(); ++i) {
+		out << "\tres |= check(" << literal(keys[i]) << ", " << i + 1 << ");\n";
+	}
+	for (auto miss: std::vector<std::string>{"key_3000", "key_", "i", "iff", "els",
+		std::string("nul\0nu", 6)}) {
+		out << "\tres |= check(" << literal(miss) << ", 0);\n";
+	}
+	out
+		<< "\tres |= empty(\"if\", 2) == token::none ? 0 : 1;\n"
+		<< "\treturn res;\n"
+		<< "}\n";
+	compile_and_run(out.str());
+}
+
+void test::test_duplicate()
+{
+	auto lookup(lccc::cc_lookup::make("int", "find", "-1"));
+	lookup->add("foo", "1");
+	lookup->add("bar", "2");
+	lookup->add("foo", "3");
+	CPPUNIT_ASSERT_THROW(lookup->generate(), std::invalid_argument);
+}
+
+// enums printed at namespace and class scope convert in both directions
+void test::test_enum()
+{
+	auto dense(lccc::cc_enum::make("color", "std::uint8_t"));
+	dense->make_scoped();
+	for (auto name: {"red", "green", "blue"}) {
+		dense->add(name);
+	}
+	dense->add("yellow", 5);
+	dense->add("crimson", 0);
+
+	auto sparse(lccc::cc_enum::make("code"));
+	sparse->add("low", -100000);
+	sparse->add("zero", 0);
+	sparse->add("one");
+	sparse->add("high", 1 << 30);
+	sparse->add("min", std::numeric_limits<std::int64_t>::min() / 2);
+
+	auto empty(lccc::cc_enum::make("nothing"));
+
+	auto ns(lccc::cc_namespace::make("ns"));
+	ns->add(dense);
+	auto cls(lccc::cc_class::make("holder"));
+	cls->vpublic()->add(sparse);
+	cls->vpublic()->add(empty);
+	ns->add(cls);
+
+	std::ostringstream out;
+	out
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <string>\n";
+	ns->print(out);
+	out
+		<< "template <typename E>\n"
+		<< "int check(char const* name, E value)\n"
+		<< "{\n"
+		<< "\tusing namespace ns;\n"
+		<< "\tE parsed;\n"
+		<< "\tif (!from_string(name, std::strlen(name), parsed) || parsed != value) {\n"
+		<< "\t\treturn 1;\n"
+		<< "\t}\n"
+		<< "\treturn std::string(to_string(value)) == name ? 0 : 1;\n"
+		<< "}\n"
+		<< "int main()\n"
+		<< "{\n"
+		<< "\tusing ns::color;\n"
+		<< "\tusing ns::holder;\n"
+		<< "\tint res(0);\n"
+		<< "\tres |= check(\"red\", color::red);\n"
+		<< "\tres |= check(\"green\", color::green);\n"
+		<< "\tres |= check(\"blue\", color::blue);\n"
+		<< "\tres |= check(\"yellow\", color::yellow);\n"
+		<< "\tres |= std::string(ns::to_string(color(4))).empty() ? 0 : 1;\n"
+		<< "\tres |= std::string(ns::to_string(color(200))).empty() ? 0 : 1;\n"
+		<< "\tcolor c;\n"
+		<< "\tres |= ns::from_string(\"crimson\", 7, c) && c == color::red ? 0 : 1;\n"
+		<< "\tres |= ns::from_string(\"purple\", 6, c) ? 1 : 0;\n"
+		<< "\tfor (auto v: {holder::low, holder::zero, holder::one, holder::high, holder::min}) {\n"
+		<< "\t\tholder::code parsed;\n"
+		<< "\t\tchar const* name(holder::to_string(v));\n"
+		<< "\t\tres |= holder::from_string(name, std::strlen(name), parsed) && parsed == v ? 0 : 1;\n"
+		<< "\t}\n"
+		<< "\tres |= std::string(holder::to_string(holder::code(7))).empty() ? 0 : 1;\n"
+		<< "\tres |= std::string(holder::to_string(holder::nothing())).empty() ? 0 : 1;\n"
+		<< "\treturn res;\n"
+		<< "}\n";
+	compile_and_run(out.str());
+}
+
+}}
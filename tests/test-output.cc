@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/header.h>
+#include <lccc/cc.h>
+#include <lccc/output.h>
+#include <unistd.h>
+#include "tree.h"
+
+namespace unittests {
+namespace output {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_async_writer();
+	void test_async_writer_flush();
+	void test_async_writer_error();
+	void test_batch_writer();
+	void test_batch_writer_threads();
+	void test_batch_writer_error();
+	void test_measure();
+	void test_mapped_writer();
+	void test_mapped_writer_size();
+	void test_mapped_writer_fallback();
+
+	void write_batch(lccc::batch_writer &);
+
+	std::string path_;
+	std::string dir_;
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_async_writer);
+	CPPUNIT_TEST(test_async_writer_flush);
+	CPPUNIT_TEST(test_async_writer_error);
+	CPPUNIT_TEST(test_batch_writer);
+	CPPUNIT_TEST(test_batch_writer_threads);
+	CPPUNIT_TEST(test_batch_writer_error);
+	CPPUNIT_TEST(test_measure);
+	CPPUNIT_TEST(test_mapped_writer);
+	CPPUNIT_TEST(test_mapped_writer_size);
+	CPPUNIT_TEST(test_mapped_writer_fallback);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{
+	char path[] = "/tmp/lccc-output-XXXXXX";
+	::close(::mkstemp(path));
+	path_ = path;
+	char dir[] = "/tmp/lccc-batch-XXXXXX";
+	dir_ = ::mkdtemp(dir);
+}
+
+void test::tearDown()
+{
+	std::remove(path_.c_str());
+	for (std::size_t i(0); i < 200; ++i) {
+		std::remove((dir_ + "/file" + std::to_string(i) + ".h").c_str());
+	}
+	::rmdir(dir_.c_str());
+}
+
+namespace {
+
+std::string read(std::string const& path)
+{
+	std::ifstream in(path);
+	std::stringstream buf;
+	buf << in.rdbuf();
+	return buf.str();
+}
+
+}
+
+void test::test_async_writer()
+{
+	auto tree(make_tree(200));
+	{
+		lccc::async_writer out(path_, 100, 3);
+		std::ostream os(&out);
+		tree->print(os);
+		out.close();
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), read(path_));
+
+	// the destructor flushes as well
+	{
+		lccc::async_writer out(path_);
+		std::ostream os(&out);
+		tree->print(os);
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), read(path_));
+}
+
+void test::test_async_writer_flush()
+{
+	lccc::async_writer out(path_, 64);
+	std::ostream os(&out);
+	os << "namespace foo {\n";
+	os.flush();
+	CPPUNIT_ASSERT_EQUAL(std::string("namespace foo {\n"), read(path_));
+	os << "}\n";
+	out.close();
+	CPPUNIT_ASSERT_EQUAL(std::string("namespace foo {\n}\n"), read(path_));
+}
+
+void test::test_async_writer_error()
+{
+	CPPUNIT_ASSERT_THROW(lccc::async_writer("/nonexistent/foo.h"), std::system_error);
+
+	lccc::async_writer out("/dev/full", 16);
+	std::ostream os(&out);
+	make_tree(10)->print(os);
+	CPPUNIT_ASSERT_THROW(out.close(), std::system_error);
+}
+
+void test::write_batch(lccc::batch_writer & out)
+{
+	for (std::size_t i(0); i < 200; ++i) {
+		auto name("file" + std::to_string(i) + ".h");
+		auto hdr(lccc::header::make(name));
+		hdr->add(make_tree(i % 5));
+		out.add(dir_ + "/" + name, *hdr);
+	}
+	out.flush();
+
+	for (std::size_t i(0); i < 200; ++i) {
+		auto name("file" + std::to_string(i) + ".h");
+		auto hdr(lccc::header::make(name));
+		hdr->add(make_tree(i % 5));
+		CPPUNIT_ASSERT_EQUAL(print(*hdr), read(dir_ + "/" + name));
+	}
+}
+
+void test::test_batch_writer()
+{
+	lccc::batch_writer out(4, lccc::batch_writer::backend::io_uring);
+	write_batch(out);
+}
+
+void test::test_batch_writer_threads()
+{
+	lccc::batch_writer out(3);
+	CPPUNIT_ASSERT(!out.uses_io_uring());
+	write_batch(out);
+}
+
+void test::test_batch_writer_error()
+{
+	lccc::batch_writer out(4, lccc::batch_writer::backend::io_uring);
+	out.add(dir_ + "/file0.h", "foo");
+	out.add("/nonexistent/foo.h", "bar");
+	out.add(dir_ + "/file1.h", "baz");
+	CPPUNIT_ASSERT_THROW(out.flush(), std::system_error);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo"), read(dir_ + "/file0.h"));
+	CPPUNIT_ASSERT_EQUAL(std::string("baz"), read(dir_ + "/file1.h"));
+
+	// a failed flush does not keep the files
+	out.flush();
+}
+
+void test::test_measure()
+{
+	auto tree(make_tree(1000));
+	CPPUNIT_ASSERT_EQUAL(print(*tree).size(), lccc::mapped_writer::measure(*tree));
+}
+
+void test::test_mapped_writer()
+{
+	auto tree(make_tree(1000));
+	{
+		lccc::mapped_writer out(path_, lccc::mapped_writer::measure(*tree));
+		CPPUNIT_ASSERT(out.mapped());
+		std::ostream os(&out);
+		tree->print(os);
+		out.close();
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), read(path_));
+
+	lccc::mapped_writer::write(path_, *make_tree(3));
+	CPPUNIT_ASSERT_EQUAL(print(*make_tree(3)), read(path_));
+
+	// larger than the first mapping write() makes
+	auto large(make_tree(40000));
+	lccc::mapped_writer::write(path_, *large);
+	CPPUNIT_ASSERT_EQUAL(print(*large), read(path_));
+}
+
+void test::test_mapped_writer_size()
+{
+	auto tree(make_tree(10));
+	auto size(lccc::mapped_writer::measure(*tree));
+	{
+		lccc::mapped_writer out(path_, size + 100);
+		std::ostream os(&out);
+		tree->print(os);
+		out.close();
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), read(path_));
+
+	lccc::mapped_writer out(path_, size - 1);
+	std::ostream os(&out);
+	tree->print(os);
+	CPPUNIT_ASSERT(!os);
+	CPPUNIT_ASSERT_THROW(out.close(), std::system_error);
+}
+
+void test::test_mapped_writer_fallback()
+{
+	auto tree(make_tree(10));
+	{
+		lccc::mapped_writer out("/dev/null", lccc::mapped_writer::measure(*tree));
+		CPPUNIT_ASSERT(!out.mapped());
+		std::ostream os(&out);
+		tree->print(os);
+		out.close();
+	}
+
+	lccc::mapped_writer out("/dev/full", lccc::mapped_writer::measure(*tree));
+	std::ostream os(&out);
+	tree->print(os);
+	CPPUNIT_ASSERT_THROW(out.close(), std::system_error);
+}
+
+}}
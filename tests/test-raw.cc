@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/cc.h>
+#include <lccc/header.h>
+#include <lccc/raw.h>
+#include <lccc/snapshot.h>
+#include <unistd.h>
+
+namespace unittests {
+namespace raw {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_raw();
+	void test_indent();
+	void test_condition();
+	void test_header();
+	void test_map();
+	void test_snapshot();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_raw);
+	CPPUNIT_TEST(test_indent);
+	CPPUNIT_TEST(test_condition);
+	CPPUNIT_TEST(test_header);
+	CPPUNIT_TEST(test_map);
+	CPPUNIT_TEST(test_snapshot);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+namespace {
+
+char const table[] =
+	"int table[] = {\n"
+	"\t1, 2, 3,\n"
+	"};\n";
+
+}
+
+void test::test_raw()
+{
+	auto src(lccc::raw::make(table, sizeof(table) - 1));
+	CPPUNIT_ASSERT(src->data() == table);
+
+	std::stringstream out;
+	src->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::string(table), out.str());
+}
+
+void test::test_indent()
+{
+	auto cls(lccc::cc_class::make("foo"));
+	cls->vprivate()->add(lccc::raw::make(table, sizeof(table) - 1));
+	auto ns(lccc::cc_namespace::make("bar"));
+	ns->add(cls);
+	ns->add(lccc::raw::make(std::string("int x;\n")));
+
+	std::stringstream out;
+	ns->print(out);
+	std::string expected(
+		"namespace bar {\n"
+		"class foo {\n"
+		"private:\n"
+		"\tint table[] = {\n"
+		"\t\t1, 2, 3,\n"
+		"\t};\n"
+		"};\n"
+		"int x;\n"
+		"}\n"
+	);
+	CPPUNIT_ASSERT_EQUAL(expected, out.str());
+}
+
+void test::test_condition()
+{
+	auto def(lccc::cpp_ifdef::make("FOO"));
+	def->add(lccc::raw::make(table, sizeof(table) - 1));
+	std::stringstream out;
+	def->print(out);
+	CPPUNIT_ASSERT_EQUAL("#ifdef FOO\n" + std::string(table) + "#endif\n", out.str());
+}
+
+void test::test_header()
+{
+	auto hdr(lccc::header::make("foo.h"));
+	hdr->add(lccc::raw::make(table, sizeof(table) - 1));
+	std::stringstream out;
+	hdr->print(out);
+	CPPUNIT_ASSERT_EQUAL(
+		"#ifndef FOO_H\n#define FOO_H\n" + std::string(table) + "#endif\n", out.str());
+}
+
+void test::test_map()
+{
+	char path[] = "/tmp/lccc-raw-XXXXXX";
+	::close(::mkstemp(path));
+	{
+		std::ofstream out(path);
+		out << table;
+	}
+
+	auto src(lccc::raw::map(path));
+	std::remove(path);
+	std::stringstream out;
+	src->print(out);
+	CPPUNIT_ASSERT_EQUAL(std::string(table), out.str());
+}
+
+void test::test_snapshot()
+{
+	auto ns(lccc::cc_namespace::make("bar"));
+	ns->add(lccc::raw::make(table, sizeof(table) - 1));
+	std::stringstream data;
+	lccc::snapshot::write(*ns, data);
+
+	std::stringstream expected;
+	ns->print(expected);
+	std::stringstream out;
+	lccc::snapshot::make(data.str())->print(out);
+	CPPUNIT_ASSERT_EQUAL(expected.str(), out.str());
+}
+
+}}
@@ -0,0 +1,120 @@
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/cc.h>
+#include <lccc/cpp.h>
+#include <lccc/renderer.h>
+#include "tree.h"
+
+namespace unittests {
+namespace renderer {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_chunks();
+	void test_small_capacity();
+	void test_abort();
+	void test_cancel();
+	void test_error();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_chunks);
+	CPPUNIT_TEST(test_small_capacity);
+	CPPUNIT_TEST(test_abort);
+	CPPUNIT_TEST(test_cancel);
+	CPPUNIT_TEST(test_error);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+void test::test_chunks()
+{
+	auto tree(make_tree(100));
+	lccc::renderer r(tree);
+	std::string out;
+	std::size_t chunks(0);
+	while (auto chunk = r.next(100)) {
+		out.append(chunk.data(), chunk.size());
+		if (chunk.size() != 100) {
+			// only the last chunk may be short
+			CPPUNIT_ASSERT(!r.next(100));
+			break;
+		}
+		++chunks;
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), out);
+	CPPUNIT_ASSERT_EQUAL(out.size() / 100, chunks);
+}
+
+void test::test_small_capacity()
+{
+	auto tree(make_tree(10));
+	lccc::renderer r(tree, 16);
+	std::string out;
+	while (auto chunk = r.next(1024)) {
+		CPPUNIT_ASSERT(chunk.size() >= 16 || out.size() + chunk.size() == print(*tree).size());
+		out.append(chunk.data(), chunk.size());
+	}
+	CPPUNIT_ASSERT_EQUAL(print(*tree), out);
+}
+
+void test::test_abort()
+{
+	auto tree(make_tree(1000));
+	lccc::renderer r(tree, 64);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(10), r.next(10).size());
+}
+
+void test::test_cancel()
+{
+	std::atomic<std::size_t> produced(0);
+	auto ns(lccc::cc_namespace::make("foo"));
+	ns->add(lccc::lazy::make([&produced](lccc::lazy::emit_t const& emit) {
+		for (std::size_t i(0); i < 200000; ++i) {
+			emit(lccc::cpp_define::make("FOO" + std::to_string(i)));
+			++produced;
+		}
+	}));
+	{
+		lccc::renderer r(ns, 64);
+		CPPUNIT_ASSERT_EQUAL(std::size_t(10), r.next(10).size());
+	}
+	// the traversal stops at the next write after destruction
+	CPPUNIT_ASSERT(produced < 1000);
+}
+
+void test::test_error()
+{
+	auto ns(lccc::cc_namespace::make("foo"));
+	ns->add(lccc::lazy::make([](lccc::lazy::emit_t const&) {
+		throw std::runtime_error("failed");
+	}));
+	lccc::renderer r(ns);
+	std::string out;
+	try {
+		while (auto chunk = r.next(4)) {
+			out.append(chunk.data(), chunk.size());
+		}
+		CPPUNIT_FAIL("exception expected");
+	} catch (std::runtime_error const&) {
+	}
+	CPPUNIT_ASSERT_EQUAL(std::string("namespace foo {\n"), out);
+}
+
+}}
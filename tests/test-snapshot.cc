@@ -0,0 +1,216 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/cc.h>
+#include <lccc/header.h>
+#include <lccc/snapshot.h>
+#include <unistd.h>
+
+namespace unittests {
+namespace snapshot {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_round_trip();
+	void test_file();
+	void test_traverse();
+	void test_corrupt();
+	void test_overflow();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_round_trip);
+	CPPUNIT_TEST(test_file);
+	CPPUNIT_TEST(test_traverse);
+	CPPUNIT_TEST(test_corrupt);
+	CPPUNIT_TEST(test_overflow);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+namespace {
+
+lccc::header::ptr_t make_tree()
+{
+	auto hdr(lccc::header::make("foo/bar.h"));
+	hdr->make_deterministic();
+	hdr->add(lccc::cpp_include::make_local("foo/baz.h"));
+	hdr->add(lccc::cpp_include::make("string"));
+	auto cond(lccc::cpp_ifdef::make("HAVE_FOO"));
+	cond->add(lccc::cpp_define::make("FOO 1"));
+	hdr->add(cond);
+
+	auto ns(lccc::cc_namespace::make("foo"));
+	hdr->add(ns);
+
+	auto cls(lccc::cc_class::make("bar"));
+	cls->make_final();
+	auto base(lccc::cc_base_class::make("baz"));
+	cls->add(base);
+	ns->add(cls);
+
+	auto ctor(cls->make_constructor());
+	ctor->add_arg("int", "x");
+	ctor->make_constexpr();
+	ctor->add(base->make_initializer("x"));
+	ctor->define(lccc::cc_block::make());
+	cls->vpublic()->add(ctor);
+
+	auto dtor(cls->make_destructor());
+	dtor->make_virtual();
+	dtor->make_final();
+	dtor->make_noexcept();
+	cls->vpublic()->add(dtor);
+
+	auto get(lccc::cc_method::make("int", "get"));
+	get->make_const();
+	get->make_noexcept("sizeof(int) == 4");
+	get->make_inline();
+	get->add_attribute("nodiscard");
+	get->add_attribute("gnu::hot");
+	auto body(lccc::cc_block::make());
+	body->src() << "return x_;\n";
+	get->define(body);
+	cls->vpublic()->add(get);
+
+	auto run(lccc::cc_method::make("void", "run"));
+	run->add_arg("std::string const&", "what");
+	run->make_abstract();
+	cls->vprotected()->add(run);
+
+	cls->vprivate()->add(lccc::cc_member::make("int", "x_"));
+	auto hot(cls->vprivate()->add(lccc::cc_member::make("long", "hot_")));
+	hot->make_hot();
+	hot->align(64);
+	auto table(cls->vprivate()->add(lccc::cc_array::make("short", "table_",
+		std::vector<short>{-1, 2, 300})));
+	table->make_static();
+	table->make_constexpr();
+	table->make_hex();
+	table->align(16);
+
+	auto e(lccc::cc_enum::make("mode", "short"));
+	e->make_scoped();
+	e->add("off", -1);
+	e->add("on");
+	ns->add(e);
+	cls->vpublic()->add(lccc::cc_enum::make("empty"));
+	return hdr;
+}
+
+std::string print(lccc::src const& node)
+{
+	std::stringstream out;
+	node.print(out);
+	return out.str();
+}
+
+}
+
+void test::test_round_trip()
+{
+	auto hdr(make_tree());
+	std::stringstream data;
+	lccc::snapshot::write(*hdr, data);
+
+	auto snap(lccc::snapshot::make(data.str()));
+	auto loaded(snap->load());
+	CPPUNIT_ASSERT(std::dynamic_pointer_cast<lccc::header>(loaded));
+	CPPUNIT_ASSERT_EQUAL(print(*hdr), print(*loaded));
+
+	std::stringstream out;
+	snap->print(out);
+	CPPUNIT_ASSERT_EQUAL(print(*hdr), out.str());
+}
+
+void test::test_file()
+{
+	char path[] = "/tmp/lccc-snapshot-XXXXXX";
+	int fd(::mkstemp(path));
+	CPPUNIT_ASSERT(fd >= 0);
+	::close(fd);
+
+	auto hdr(make_tree());
+	{
+		std::ofstream out(path, std::ios::binary);
+		lccc::snapshot::write(*hdr, out);
+	}
+
+	auto snap(lccc::snapshot::open(path));
+	std::remove(path);
+	CPPUNIT_ASSERT_EQUAL(print(*hdr), print(*snap->load()));
+
+	std::stringstream out;
+	snap->print(out);
+	CPPUNIT_ASSERT_EQUAL(print(*hdr), out.str());
+}
+
+void test::test_traverse()
+{
+	std::stringstream data;
+	lccc::snapshot::write(*make_tree(), data);
+	auto snap(lccc::snapshot::make(data.str()));
+
+	auto root(snap->root());
+	CPPUNIT_ASSERT(root.type() == lccc::snapshot::kind::header);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/bar.h"), root.field(0).str());
+
+	// header -> guard -> #ifndef: define, includes, #ifdef, namespace
+	auto cond(root.child(0).child(0));
+	CPPUNIT_ASSERT(cond.type() == lccc::snapshot::kind::cpp_condition);
+	CPPUNIT_ASSERT_EQUAL(std::size_t(5), cond.children());
+	CPPUNIT_ASSERT_EQUAL(std::string("string"), cond.child(1).field(0).str());
+	CPPUNIT_ASSERT_EQUAL(std::string("foo/baz.h"), cond.child(2).field(0).str());
+	CPPUNIT_ASSERT_EQUAL(1, int(cond.child(2).flags()));
+
+	auto ns(cond.child(4));
+	CPPUNIT_ASSERT(ns.type() == lccc::snapshot::kind::cc_namespace);
+	CPPUNIT_ASSERT_EQUAL(std::string("foo"), ns.field(0).str());
+
+	auto cls(ns.child(0));
+	CPPUNIT_ASSERT(cls.type() == lccc::snapshot::kind::cc_class);
+	CPPUNIT_ASSERT_EQUAL(std::string("bar"), cls.field(0).str());
+	CPPUNIT_ASSERT(cls.child(0).type() == lccc::snapshot::kind::cc_base_class);
+	CPPUNIT_ASSERT_EQUAL(std::string("public"), cls.child(1).field(0).str());
+}
+
+void test::test_corrupt()
+{
+	std::stringstream data;
+	lccc::snapshot::write(*make_tree(), data);
+	auto str(data.str());
+
+	CPPUNIT_ASSERT_THROW(lccc::snapshot::make(str.substr(0, str.size() - 1)), std::runtime_error);
+	str[0] = 'X';
+	CPPUNIT_ASSERT_THROW(lccc::snapshot::make(str), std::runtime_error);
+}
+
+void test::test_overflow()
+{
+	// the field count of a record is 16 bit wide
+	auto cls(lccc::cc_class::make("foo"));
+	for (std::size_t i(0); i < 0x10000; ++i) {
+		cls->add_template_parameter("typename T" + std::to_string(i));
+	}
+	std::stringstream data;
+	CPPUNIT_ASSERT_THROW(lccc::snapshot::write(*cls, data), std::length_error);
+}
+
+}}
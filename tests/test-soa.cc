@@ -0,0 +1,149 @@
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/soa.h>
+#include "compile.h"
+
+namespace unittests {
+namespace soa {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_compile();
+	void test_empty();
+	void test_names();
+	void test_align();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_compile);
+	CPPUNIT_TEST(test_empty);
+	CPPUNIT_TEST(test_names);
+	CPPUNIT_TEST(test_align);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+void test::test_compile()
+{
+	auto particle(lccc::cc_class::make("particle"));
+	particle->vpublic()->add(lccc::cc_member::make("float", "x"));
+	particle->vpublic()->add(lccc::cc_member::make("float", "y"));
+	particle->vpublic()->add(lccc::cc_member::make("double", "mass"));
+	particle->vpublic()->add(lccc::cc_member::make("std::int16_t", "id_"));
+	particle->vpublic()->add(lccc::cc_member::make("static int", "count"));
+	auto soa(lccc::cc_soa::make(particle, "particles"));
+	soa->align(32);
+
+	std::ostringstream code;
+	code
+		<< "#include <cstddef>\n"
+		<< "#include <cstdint>\n"
+		<< "#include <cstdlib>\n"
+		<< "#include <cstring>\n"
+		<< "#include <new>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <stdlib.h>\n";
+	particle->print(code);
+	soa->generate()->print(code);
+	code << R"(
+bool aligned(void const* p)
+{
+	return reinterpret_cast<std::uintptr_t>(p) % 32 == 0;
+}
+
+int main()
+{
+	particles p;
+	int res(p.size() == 0 ? 0 : 1);
+	for (int i(0); i < 100; ++i) {
+		p.push_back(float(i), float(2 * i), i * 0.5, std::int16_t(i));
+	}
+	particle row;
+	row.x = -1;
+	row.y = -2;
+	row.mass = -3;
+	row.id_ = -4;
+	p.push_back(row);
+	res |= p.size() == 101 ? 0 : 1;
+	res |= p.capacity() >= 101 ? 0 : 1;
+	res |= aligned(p.x()) && aligned(p.y()) && aligned(p.mass()) && aligned(p.id()) ? 0 : 1;
+
+	float sum(0);
+	for (std::size_t i(0); i < 100; ++i) {
+		sum += p.x()[i];
+	}
+	res |= sum == 4950 ? 0 : 1;
+
+	p[3].y() = 42;
+	res |= p.y()[3] == 42 && p[3].mass() == 1.5 ? 0 : 1;
+
+	p.erase_swap(0);
+	res |= p.size() == 100 && p[0].id() == -4 && p[0].x() == -1 ? 0 : 1;
+
+	p.resize(200);
+	res |= p.size() == 200 && p[150].mass() == 0 && p[99].id() == 99 ? 0 : 1;
+	res |= aligned(p.x()) && aligned(p.mass()) ? 0 : 1;
+	particles const& c(p);
+	res |= c.y()[3] == 42 ? 0 : 1;
+
+	// appending a row of the columns themselves while they grow
+	std::size_t full(p.capacity());
+	p.resize(full);
+	p.push_back(p.x()[3], p.y()[3], p.mass()[3], p.id()[3]);
+	res |= p.capacity() > full && p[full].y() == 42 && p[full].id() == 3 ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_empty()
+{
+	auto soa(lccc::cc_soa::make(lccc::cc_class::make("foo"), "foos"));
+	CPPUNIT_ASSERT_THROW(soa->generate(), std::invalid_argument);
+
+	auto statics(lccc::cc_class::make("foo"));
+	statics->vpublic()->add(lccc::cc_member::make("static int", "count"));
+	CPPUNIT_ASSERT_THROW(lccc::cc_soa::make(statics, "foos")->generate(), std::invalid_argument);
+}
+
+void test::test_names()
+{
+	for (auto name: {"size", "capacity_", "reserve", "push_back", "foos", "index_"}) {
+		auto cls(lccc::cc_class::make("foo"));
+		cls->vpublic()->add(lccc::cc_member::make("int", name));
+		CPPUNIT_ASSERT_THROW(lccc::cc_soa::make(cls, "foos")->generate(), std::invalid_argument);
+	}
+
+	auto twice(lccc::cc_class::make("foo"));
+	twice->vpublic()->add(lccc::cc_member::make("int", "x"));
+	twice->vprivate()->add(lccc::cc_member::make("int", "x_"));
+	CPPUNIT_ASSERT_THROW(lccc::cc_soa::make(twice, "foos")->generate(), std::invalid_argument);
+}
+
+void test::test_align()
+{
+	auto soa(lccc::cc_soa::make(lccc::cc_class::make("foo"), "foos"));
+	for (std::size_t alignment: {0, 1, 4, 24, 96}) {
+		CPPUNIT_ASSERT_THROW(soa->align(alignment), std::invalid_argument);
+	}
+	soa->align(sizeof(void*));
+	soa->align(4096);
+}
+
+}}
@@ -0,0 +1,275 @@
+/*
+   Copyright (c) 2014, 2017 Andreas Fett
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright notice, this
+     list of conditions and the following disclaimer.
+
+   * Redistributions in binary form must reproduce the above copyright notice,
+     this list of conditions and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <sstream>
+#include <stdexcept>
+#include <cppunit/extensions/HelperMacros.h>
+#include <lccc/tags.h>
+#include "compile.h"
+
+namespace unittests {
+namespace tags {
+
+class test : public CppUnit::TestCase {
+public:
+	test();
+	void setUp();
+	void tearDown();
+
+private:
+	void test_compile();
+	void test_move_only_compile();
+	void test_order();
+	void test_invalid();
+
+	CPPUNIT_TEST_SUITE(test);
+	CPPUNIT_TEST(test_compile);
+	CPPUNIT_TEST(test_move_only_compile);
+	CPPUNIT_TEST(test_order);
+	CPPUNIT_TEST(test_invalid);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test);
+
+test::test()
+{ }
+
+void test::setUp()
+{ }
+
+void test::tearDown()
+{ }
+
+lccc::cc_class::ptr_t derived(std::string const& name, std::string const& base)
+{
+	auto cls(lccc::cc_class::make(name));
+	cls->add(lccc::cc_base_class::make(base));
+	return cls;
+}
+
+lccc::cc_class::ptr_t binary_op(std::string const& name)
+{
+	auto cls(lccc::cc_class::make(name));
+	auto base(cls->add(lccc::cc_base_class::make("binary")));
+	auto ctor(cls->vpublic()->add(cls->make_constructor()));
+	ctor->add_arg("int", "lhs");
+	ctor->add_arg("int", "rhs");
+	ctor->add(base->make_initializer("lhs, rhs"));
+	ctor->define(lccc::cc_block::make());
+	return cls;
+}
+
+void test::test_compile()
+{
+	auto node(lccc::cc_class::make("node"));
+	auto expr(derived("expr", "node"));
+	auto stmt(derived("stmt", "node"));
+
+	auto literal(derived("literal", "expr"));
+	auto lit_ctor(literal->vpublic()->add(literal->make_constructor()));
+	lit_ctor->add_arg("int", "v");
+	lit_ctor->add(lccc::cc_base_class::make("value")->make_initializer("v"));
+	lit_ctor->define(lccc::cc_block::make())->src() << "value += 0;\n";
+	literal->vpublic()->add(lccc::cc_member::make("int", "value"));
+
+	auto binary(derived("binary", "expr"));
+	auto bin_ctor(binary->vprotected()->add(binary->make_constructor()));
+	bin_ctor->add_arg("int", "l");
+	bin_ctor->add_arg("int", "r");
+	bin_ctor->add(lccc::cc_base_class::make("lhs")->make_initializer("l"));
+	bin_ctor->add(lccc::cc_base_class::make("rhs")->make_initializer("r"));
+	bin_ctor->define(lccc::cc_block::make());
+	binary->vpublic()->add(lccc::cc_member::make("int", "lhs"));
+	binary->vpublic()->add(lccc::cc_member::make("int", "rhs"));
+
+	auto add(binary_op("add"));
+	auto mul(binary_op("mul"));
+
+	auto tags(lccc::cc_tags::make(node));
+	for (auto cls: {expr, stmt, literal, binary, add, mul}) {
+		tags->add(cls);
+	}
+	tags->make_copyable();
+	tags->apply();
+
+	std::ostringstream code;
+	code
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <utility>\n";
+	tags->tags()->print(code);
+	for (auto cls: {node, expr, stmt, literal, binary, add, mul}) {
+		cls->print(code);
+	}
+	tags->visit()->print(code);
+	code << R"(
+struct eval {
+	int operator()(node const&) { return -1; }
+	int operator()(expr const&) { return -2; }
+	int operator()(literal const& l) { return l.value; }
+	int operator()(binary const&) { return -3; }
+	int operator()(add const& a) { return a.lhs + a.rhs; }
+	int operator()(mul const& m) { return m.lhs * m.rhs; }
+	int operator()(stmt const&) { return -4; }
+};
+
+static_assert(!std::is_polymorphic<node>::value, "no vtable needed");
+static_assert(sizeof(node_tag) == 1, "one byte tags");
+
+int main()
+{
+	node n;
+	expr e;
+	stmt s;
+	literal l(7);
+	add a(2, 3);
+	mul m(2, 3);
+	add c(a);
+	node const& base(m);
+	node sliced(base);
+	binary partial(static_cast<binary const&>(c));
+	add moved(std::move(c));
+	node assigned;
+	assigned = base;
+	binary& target(a);
+	target = m;
+	int res(0);
+	res |= visit(base, eval()) == 6 ? 0 : 1;
+	res |= visit(static_cast<node&>(a), eval()) == 5 ? 0 : 1;
+	res |= visit(static_cast<node&>(c), eval()) == 5 ? 0 : 1;
+	res |= visit(static_cast<node&>(l), eval()) == 7 ? 0 : 1;
+	res |= visit(static_cast<node&>(s), eval()) == -4 ? 0 : 1;
+	res |= visit(static_cast<node&>(e), eval()) == -2 ? 0 : 1;
+	res |= visit(n, eval()) == -1 ? 0 : 1;
+	res |= visit(sliced, eval()) == -1 && visit(assigned, eval()) == -1 ? 0 : 1;
+	res |= visit(static_cast<node&>(partial), eval()) == -3 ? 0 : 1;
+	res |= visit(static_cast<node&>(moved), eval()) == 5 ? 0 : 1;
+	res |= visit(static_cast<node&>(a), eval()) == 5 ? 0 : 1;
+	res |= a.tag() == node_tag::add && n.tag() == node_tag::node ? 0 : 1;
+	res |= expr::classof(m) && expr::classof(l) && expr::classof(e) && !expr::classof(s) ? 0 : 1;
+	res |= binary::classof(a) && binary::classof(m) && !binary::classof(l) ? 0 : 1;
+	res |= add::classof(a) && !add::classof(m) && stmt::classof(s) && !stmt::classof(n) ? 0 : 1;
+	res |= std::strcmp(to_string(node_tag::mul), "mul") == 0 ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_move_only_compile()
+{
+	auto resource(lccc::cc_class::make("resource"));
+	auto ctor(resource->vpublic()->add(resource->make_constructor()));
+	ctor->add_arg("int", "v");
+	ctor->add(lccc::cc_base_class::make("p_")->make_initializer("new int(v)"));
+	ctor->define(lccc::cc_block::make());
+	resource->vpublic()->add(lccc::cc_member::make("std::unique_ptr<int>", "p_"));
+	auto file(derived("file", "resource"));
+	auto file_ctor(file->vpublic()->add(file->make_constructor()));
+	file_ctor->add(lccc::cc_base_class::make("resource")->make_initializer("3"));
+	file_ctor->define(lccc::cc_block::make());
+
+	auto tags(lccc::cc_tags::make(resource));
+	tags->add(file);
+	tags->apply();
+
+	std::ostringstream code;
+	code
+		<< "#include <cstdint>\n"
+		<< "#include <cstring>\n"
+		<< "#include <memory>\n"
+		<< "#include <type_traits>\n"
+		<< "#include <utility>\n";
+	tags->tags()->print(code);
+	resource->print(code);
+	file->print(code);
+	code << R"(
+static_assert(!std::is_copy_constructible<resource>::value, "resource is move-only");
+static_assert(!std::is_copy_assignable<file>::value, "file is move-only");
+
+int main()
+{
+	file f;
+	resource sliced(std::move(f));
+	file moved(std::move(f));
+	resource target(1);
+	target = std::move(sliced);
+	int res(0);
+	res |= sliced.tag() == resource_tag::resource && moved.tag() == resource_tag::file ? 0 : 1;
+	res |= target.tag() == resource_tag::resource && *target.p_ == 3 ? 0 : 1;
+	return res;
+}
+)";
+	unittests::compile_and_run(code.str());
+}
+
+void test::test_order()
+{
+	auto tags(lccc::cc_tags::make(lccc::cc_class::make("a")));
+	tags->add(derived("b", "a"));
+	tags->add(derived("c", "a"));
+	tags->add(derived("d", "b"));
+	std::ostringstream os;
+	tags->tags()->print(os);
+	CPPUNIT_ASSERT_EQUAL(std::string("enum class a_tag : std::uint8_t {\n\ta,\n\tb,\n\td,\n\tc,\n};\n"),
+		os.str().substr(0, os.str().find(";\n") + 2));
+}
+
+void test::test_invalid()
+{
+	auto unrelated(lccc::cc_tags::make(lccc::cc_class::make("a")));
+	unrelated->add(derived("b", "x"));
+	CPPUNIT_ASSERT_THROW(unrelated->tags(), std::invalid_argument);
+
+	auto twice(lccc::cc_tags::make(lccc::cc_class::make("a")));
+	twice->add(derived("b", "a"));
+	auto diamond(derived("c", "a"));
+	diamond->add(lccc::cc_base_class::make("b"));
+	twice->add(diamond);
+	CPPUNIT_ASSERT_THROW(twice->apply(), std::invalid_argument);
+
+	auto root(lccc::cc_class::make("a"));
+	auto ctor(root->vpublic()->add(root->make_constructor()));
+	ctor->add_arg("int");
+	CPPUNIT_ASSERT_THROW(lccc::cc_tags::make(root)->apply(), std::invalid_argument);
+
+	auto defaulted(lccc::cc_class::make("a"));
+	defaulted->vpublic()->add(defaulted->make_constructor())->make_default();
+	CPPUNIT_ASSERT_THROW(lccc::cc_tags::make(defaulted)->apply(), std::invalid_argument);
+
+	auto copy(lccc::cc_class::make("a"));
+	auto copy_ctor(copy->vpublic()->add(copy->make_constructor()));
+	copy_ctor->add_arg("a const&");
+	copy_ctor->make_default();
+	CPPUNIT_ASSERT_THROW(lccc::cc_tags::make(copy)->apply(), std::invalid_argument);
+
+	auto assign(lccc::cc_class::make("a"));
+	assign->vpublic()->add(assign->make_copy_assignment())->make_default();
+	CPPUNIT_ASSERT_THROW(lccc::cc_tags::make(assign)->apply(), std::invalid_argument);
+}
+
+}}
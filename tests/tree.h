@@ -0,0 +1,32 @@
+#ifndef UNITTESTS_TREE_H
+#define UNITTESTS_TREE_H
+
+#include <sstream>
+#include <string>
+#include <lccc/cc.h>
+
+namespace unittests {
+
+// namespace foo with classes bar0 ... bar<classes - 1>
+inline lccc::cc_namespace::ptr_t make_tree(std::size_t classes)
+{
+	auto ns(lccc::cc_namespace::make("foo"));
+	for (std::size_t i(0); i < classes; ++i) {
+		auto cls(lccc::cc_class::make("bar" + std::to_string(i)));
+		cls->vpublic()->add(lccc::cc_method::make("int", "get"));
+		cls->vprivate()->add(lccc::cc_member::make("int", "value_"));
+		ns->add(cls);
+	}
+	return ns;
+}
+
+inline std::string print(lccc::src const& node)
+{
+	std::stringstream out;
+	node.print(out);
+	return out.str();
+}
+
+}
+
+#endif